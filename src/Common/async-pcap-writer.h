@@ -0,0 +1,212 @@
+/* Asynchronous batched pcap writer
+   --------------------------------
+
+   Keeps file I/O off the simulator thread. Write() only appends the pcap record
+   to an in-memory buffer of its file; full buffers are handed to one background
+   writer thread, which does the fwrite() calls for all files. With compression
+   the thread streams each file through "gzip -c" (<name>.pcap.gz).
+
+   The simulator thread only waits when more than maxQueuedBytes are pending,
+   i.e. when the disk cannot keep up at all. Close() (or the destructor) flushes
+   the partial buffers and waits for the writer thread.
+*/
+
+#ifndef ASYNC_PCAP_WRITER_H
+#define ASYNC_PCAP_WRITER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+namespace ns3 {
+
+class AsyncPcapWriter {
+public:
+    AsyncPcapWriter(uint32_t chunkSize = 4 << 20, uint64_t maxQueuedBytes = 256 << 20)
+    : m_chunkSize(chunkSize),
+      m_maxQueuedBytes(maxQueuedBytes),
+      m_queuedBytes(0),
+      m_started(false),
+      m_stopping(false) {
+        pthread_mutex_init(&m_mutex, 0);
+        pthread_cond_init(&m_work, 0);
+        pthread_cond_init(&m_space, 0);
+    }
+
+    ~AsyncPcapWriter() {
+        Close();
+        pthread_cond_destroy(&m_space);
+        pthread_cond_destroy(&m_work);
+        pthread_mutex_destroy(&m_mutex);
+    }
+
+    //Open a capture file (DLT_IEEE802_11 by default); returns its handle
+    uint32_t Open(const std::string &filename, uint32_t snapLen, bool compress, uint32_t dataLinkType = 105) {
+        File file;
+        file.name = compress ? filename + ".gz" : filename;
+        file.stream = compress ? popen(("gzip -c > '" + file.name + "'").c_str(), "w") : std::fopen(file.name.c_str(), "wb");
+        file.compressed = compress;
+        file.snapLen = snapLen;
+        if (file.stream == 0) {
+            NS_FATAL_ERROR("Cannot open capture file " << file.name);
+        }
+
+        //pcap global header, native byte order like ns-3's PcapFile
+        uint32_t magic = 0xa1b2c3d4;
+        uint16_t versionMajor = 2;
+        uint16_t versionMinor = 4;
+        int32_t zone = 0;
+        uint32_t sigFigs = 0;
+        Append(file.buffer, &magic, 4);
+        Append(file.buffer, &versionMajor, 2);
+        Append(file.buffer, &versionMinor, 2);
+        Append(file.buffer, &zone, 4);
+        Append(file.buffer, &sigFigs, 4);
+        Append(file.buffer, &snapLen, 4);
+        Append(file.buffer, &dataLinkType, 4);
+
+        //The writer thread looks up streams by handle while holding the mutex
+        pthread_mutex_lock(&m_mutex);
+        m_files.push_back(file);
+        pthread_mutex_unlock(&m_mutex);
+        if (!m_started) {
+            m_started = true;
+            pthread_create(&m_thread, 0, &AsyncPcapWriter::ThreadMain, this);
+        }
+        return m_files.size() - 1;
+    }
+
+    void Write(uint32_t handle, Time t, Ptr<const Packet> packet) {
+        File &file = m_files[handle];
+        uint64_t current = t.GetMicroSeconds();
+        uint32_t seconds = current / 1000000;
+        uint32_t microSeconds = current % 1000000;
+        uint32_t origLen = packet->GetSize();
+        uint32_t inclLen = origLen > file.snapLen ? file.snapLen : origLen;
+        Append(file.buffer, &seconds, 4);
+        Append(file.buffer, &microSeconds, 4);
+        Append(file.buffer, &inclLen, 4);
+        Append(file.buffer, &origLen, 4);
+        std::vector<uint8_t>::size_type offset = file.buffer.size();
+        file.buffer.resize(offset + inclLen);
+        packet->CopyData(&file.buffer[offset], inclLen);
+        if (file.buffer.size() >= m_chunkSize) {
+            Submit(handle);
+        }
+    }
+
+    //Flush everything, stop the writer thread and close all files
+    void Close() {
+        if (!m_started) {
+            return;
+        }
+        for (uint32_t i = 0; i < m_files.size(); i++) {
+            Submit(i);
+        }
+        pthread_mutex_lock(&m_mutex);
+        m_stopping = true;
+        pthread_cond_signal(&m_work);
+        pthread_mutex_unlock(&m_mutex);
+        pthread_join(m_thread, 0);
+        m_started = false;
+        m_stopping = false;
+        for (uint32_t i = 0; i < m_files.size(); i++) {
+            if (m_files[i].compressed) {
+                pclose(m_files[i].stream);
+            } else {
+                std::fclose(m_files[i].stream);
+            }
+        }
+        m_files.clear();
+    }
+
+private:
+    struct File {
+        std::string name;
+        std::FILE *stream;
+        bool compressed;
+        uint32_t snapLen;
+        std::vector<uint8_t> buffer; //Records not yet handed to the writer thread
+    };
+
+    struct Chunk {
+        uint32_t handle;
+        std::vector<uint8_t> data;
+    };
+
+    static void Append(std::vector<uint8_t> &buffer, const void *data, uint32_t size) {
+        const uint8_t *bytes = static_cast<const uint8_t *> (data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    //Move the buffer of a file to the writer queue
+    void Submit(uint32_t handle) {
+        File &file = m_files[handle];
+        if (file.buffer.empty()) {
+            return;
+        }
+        pthread_mutex_lock(&m_mutex);
+        while (m_queuedBytes > m_maxQueuedBytes) {
+            pthread_cond_wait(&m_space, &m_mutex);
+        }
+        m_queue.push_back(Chunk());
+        m_queue.back().handle = handle;
+        m_queue.back().data.swap(file.buffer);
+        m_queuedBytes += m_queue.back().data.size();
+        pthread_cond_signal(&m_work);
+        pthread_mutex_unlock(&m_mutex);
+        file.buffer.reserve(m_chunkSize + 65536);
+    }
+
+    static void *ThreadMain(void *self) {
+        static_cast<AsyncPcapWriter *> (self)->DoWrite();
+        return 0;
+    }
+
+    void DoWrite() {
+        pthread_mutex_lock(&m_mutex);
+        while (true) {
+            while (m_queue.empty() && !m_stopping) {
+                pthread_cond_wait(&m_work, &m_mutex);
+            }
+            if (m_queue.empty()) {
+                break;
+            }
+            Chunk chunk;
+            chunk.handle = m_queue.front().handle;
+            chunk.data.swap(m_queue.front().data);
+            m_queue.pop_front();
+            std::FILE *stream = m_files[chunk.handle].stream;
+            pthread_mutex_unlock(&m_mutex);
+
+            std::fwrite(&chunk.data[0], 1, chunk.data.size(), stream);
+
+            pthread_mutex_lock(&m_mutex);
+            m_queuedBytes -= chunk.data.size();
+            pthread_cond_signal(&m_space);
+        }
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+    uint32_t m_chunkSize;
+    uint64_t m_maxQueuedBytes;
+    uint64_t m_queuedBytes; //Guarded by m_mutex
+    std::vector<File> m_files; //Resized under m_mutex, buffers only touched by the simulator thread
+    std::deque<Chunk> m_queue; //Guarded by m_mutex
+    bool m_started;
+    bool m_stopping; //Guarded by m_mutex
+    pthread_t m_thread;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_work;
+    pthread_cond_t m_space;
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_PCAP_WRITER_H */
@@ -0,0 +1,186 @@
+/* Analytical DCF model (Bianchi)
+   ------------------------------
+
+   Saturation throughput and conditional collision probability of n stations
+   running 802.11 DCF with RTS/CTS (G. Bianchi, "Performance Analysis of the
+   IEEE 802.11 Distributed Coordination Function", JSAC 2000). The fixed point
+
+     tau = 2 (1 - 2p) / ((1 - 2p)(W + 1) + p W (1 - (2p)^m))
+     p   = 1 - (1 - tau)^(n - 1)
+
+   (W = CWmin + 1, m = log2((CWmax + 1) / W)) is solved by bisection on p, and
+
+     S = Ps Ptr E[P] / ((1 - Ptr) slot + Ptr Ps Ts + Ptr (1 - Ps) Tc)
+
+   with the RTS/CTS durations
+
+     Ts = RTS + SIFS + CTS + SIFS + DATA + SIFS + ACK + DIFS
+     Tc = RTS + DIFS
+
+   Solving one point takes microseconds, so whole parameter spaces can be
+   screened before simulating. p corresponds to the simulated
+   collisionProbability (missed CTS / RTS) and S to totalThroughput; like the
+   simulated value (FlowMonitor rxBytes), the reported model_totalThroughput
+   counts the 28 bytes of UDP/IPv4 headers of every packet. The model assumes
+   saturated stations (every station always has a frame queued) and unlimited
+   retries.
+
+   The timing is that of 802.11b DSSS (DcfTiming::FromPhyMode); other PHY
+   modes are rejected rather than predicted with the wrong slot and preamble.
+*/
+
+#ifndef BIANCHI_MODEL_H
+#define BIANCHI_MODEL_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include "result-record.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+//802.11 PHY/MAC timing used by the model (durations in seconds, rates in bit/s)
+struct DcfTiming {
+    double slot;
+    double sifs;
+    double difs;
+    double plcpOverhead; //Preamble + PLCP header of every frame
+    double dataRate;
+    double controlRate; //RTS, CTS and ACK
+    uint32_t cwMin;
+    uint32_t cwMax;
+    uint32_t payloadOverhead; //UDP + IPv4 + LLC/SNAP bytes added to the UDP payload
+    uint32_t macOverhead; //MAC header + FCS bytes of a data frame
+    uint32_t measuredOverhead; //UDP + IPv4 header bytes counted in the simulated throughput
+
+    //802.11b DSSS with long preamble, data and control at 11 Mbps as in the Problem3 scripts
+    static DcfTiming Dsss(double dataRate = 11e6, double controlRate = 11e6) {
+        DcfTiming timing;
+        timing.slot = 20e-6;
+        timing.sifs = 10e-6;
+        timing.difs = timing.sifs + 2 * timing.slot;
+        timing.plcpOverhead = 192e-6;
+        timing.dataRate = dataRate;
+        timing.controlRate = controlRate;
+        timing.cwMin = 31;
+        timing.cwMax = 1023;
+        timing.payloadOverhead = 8 + 20 + 8;
+        timing.macOverhead = 24 + 4;
+        timing.measuredOverhead = 8 + 20;
+        return timing;
+    }
+
+    //Timing of a ConstantRateWifiManager mode used for data and control frames
+    static DcfTiming FromPhyMode(const std::string &phyMode) {
+        static const char *modes[] = {"DsssRate1Mbps", "DsssRate2Mbps", "DsssRate5_5Mbps", "DsssRate11Mbps"};
+        static const double rates[] = {1e6, 2e6, 5.5e6, 11e6};
+        for (uint32_t i = 0; i < 4; i++) {
+            if (phyMode == modes[i]) {
+                return Dsss(rates[i], rates[i]);
+            }
+        }
+        NS_FATAL_ERROR("The DCF model only covers 802.11b DSSS modes, not " << phyMode);
+        return Dsss();
+    }
+
+    //PLCP overhead + payload rounded up to whole microseconds, like the DSSS PHY
+    double FrameDuration(uint32_t bytes, double rate) const {
+        return plcpOverhead + std::ceil(bytes * 8.0 / rate * 1e6) * 1e-6;
+    }
+};
+
+class BianchiModel {
+public:
+    struct Prediction {
+        double tau; //Transmission probability per slot
+        double collisionProbability; //p
+        double throughput; //Total, bit/s
+    };
+
+    BianchiModel(const DcfTiming &timing = DcfTiming::Dsss())
+    : m_timing(timing) {
+    }
+
+    Prediction Solve(uint32_t nStations, uint32_t packetSize) const {
+        Prediction prediction;
+        if (nStations == 0) {
+            prediction.tau = 0.0;
+            prediction.collisionProbability = 0.0;
+            prediction.throughput = 0.0;
+            return prediction;
+        }
+
+        //p - (1 - (1 - tau(p))^(n-1)) is increasing in p: bisection (p = 0 for a single station)
+        double low = 0.0;
+        double high = nStations == 1 ? 0.0 : 1.0;
+        for (uint32_t i = 0; nStations > 1 && i < 60; i++) {
+            double p = (low + high) / 2;
+            if (p - (1 - std::pow(1 - Tau(p), static_cast<double> (nStations - 1))) > 0) {
+                high = p;
+            } else {
+                low = p;
+            }
+        }
+        double p = (low + high) / 2;
+        double tau = Tau(p);
+
+        const DcfTiming &t = m_timing;
+        double payloadBits = packetSize * 8.0;
+        uint32_t dataBytes = packetSize + t.payloadOverhead + t.macOverhead;
+        double rts = t.FrameDuration(20, t.controlRate);
+        double cts = t.FrameDuration(14, t.controlRate);
+        double ack = t.FrameDuration(14, t.controlRate);
+        double ts = rts + t.sifs + cts + t.sifs + t.FrameDuration(dataBytes, t.dataRate) + t.sifs + ack + t.difs;
+        double tc = rts + t.difs;
+
+        double ptr = 1 - std::pow(1 - tau, static_cast<double> (nStations));
+        double ps = nStations * tau * std::pow(1 - tau, static_cast<double> (nStations - 1)) / ptr;
+
+        prediction.tau = tau;
+        prediction.collisionProbability = p;
+        prediction.throughput = ps * ptr * payloadBits / ((1 - ptr) * t.slot + ptr * ps * ts + ptr * (1 - ps) * tc);
+        return prediction;
+    }
+
+    //Add the prediction (model_*, Mbps = 2^20 bit/s) to a single-cell record and,
+    //if it holds simulated values, the gap simulation - model
+    void AddPrediction(ResultRecord &record, uint32_t nStations, uint32_t packetSize, const std::string &dataRate) const {
+        Prediction prediction = Solve(nStations, packetSize);
+        //Same basis as the simulation: payload plus UDP/IPv4 headers
+        double throughput = packetSize == 0 ? 0.0
+                : prediction.throughput * (packetSize + m_timing.measuredOverhead) / packetSize / 1024 / 1024;
+        //Saturation holds if the offered load exceeds what the channel delivers
+        double offered = static_cast<double> (DataRate(dataRate).GetBitRate()) * nStations;
+        record.Set("model_saturated", offered >= prediction.throughput ? 1 : 0);
+        record.Set("model_collisionProbability", prediction.collisionProbability);
+        record.Set("model_totalThroughput", throughput);
+        if (record.Has("collisionProbability")) {
+            record.Set("gap_collisionProbability", record.GetDouble("collisionProbability") - prediction.collisionProbability);
+        }
+        if (record.Has("totalThroughput")) {
+            record.Set("gap_totalThroughput", record.GetDouble("totalThroughput") - throughput);
+        }
+    }
+
+private:
+    //Same as the expression above with (1 - (2p)^m) / (1 - 2p) expanded, defined at p = 1/2
+    double Tau(double p) const {
+        double w = m_timing.cwMin + 1;
+        uint32_t m = static_cast<uint32_t> (std::floor(std::log((m_timing.cwMax + 1.0) / w) / std::log(2.0) + 0.5));
+        double sum = 0.0;
+        double power = 1.0;
+        for (uint32_t i = 0; i < m; i++) {
+            sum += power;
+            power *= 2 * p;
+        }
+        return 2 / (1 + w + p * w * sum);
+    }
+
+    DcfTiming m_timing;
+};
+
+} // namespace ns3
+
+#endif /* BIANCHI_MODEL_H */
@@ -0,0 +1,171 @@
+/* Multi-cell chains and grids
+   ---------------------------
+
+   Generates the flow-in-the-middle pattern of Problem2 for any number of
+   cells: R x C AP/STA cells on a grid, each carrying one saturated AP -> STA
+   flow, where every cell conflicts with its horizontal, vertical and diagonal
+   neighbor cells (all four AP/STA cross pairs, as A/a and B/b in problem2).
+   A chain of K cells is the 1 x K grid; the 1 x 3 chain is problem2.
+
+   Cells are named A<i>/a<i> in a chain (1-based) and A<r>-<c>/a<r>-<c> in a
+   grid, SSIDs and subnets follow the cell index. The topology is built in
+   time linear in the number of cells, and the loss model of the scenario
+   switches to sparse storage for large networks, so setup time and memory
+   grow linearly as well.
+
+   Middle-flow starvation is summarized by neighbor count: a chain has edge
+   cells (1 neighbor) and middle cells (2), a grid corners (3), edges (5) and
+   inner cells (8).
+*/
+
+#ifndef CELL_GRID_H
+#define CELL_GRID_H
+
+#include "ns3/core-module.h"
+
+#include "conflict-graph-topology.h"
+#include "result-record.h"
+
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct CellGrid {
+    uint32_t rows;
+    uint32_t cols;
+    std::string dataRate; //Of every flow
+    uint32_t packetSize;
+
+    CellGrid(uint32_t rows = 1, uint32_t cols = 3)
+    : rows(rows),
+      cols(cols),
+      dataRate("11Mbps"),
+      packetSize(1024) {
+    }
+
+    //"K" (chain of K cells) or "RxC" (grid)
+    static CellGrid Parse(const std::string &spec) {
+        std::string::size_type x = spec.find('x');
+        uint32_t rows = x == std::string::npos ? 1 : std::strtoul(spec.substr(0, x).c_str(), 0, 10);
+        uint32_t cols = std::strtoul(spec.substr(x == std::string::npos ? 0 : x + 1).c_str(), 0, 10);
+        if (rows == 0 || cols == 0) {
+            NS_FATAL_ERROR("Cannot parse cell grid \"" << spec << "\" (K or RxC)");
+        }
+        return CellGrid(rows, cols);
+    }
+
+    uint32_t GetNCells() const {
+        return rows * cols;
+    }
+
+    std::string GetCellSuffix(uint32_t r, uint32_t c) const {
+        std::ostringstream os;
+        if (rows == 1) {
+            os << c + 1;
+        } else {
+            os << r + 1 << "-" << c + 1;
+        }
+        return os.str();
+    }
+
+    //Neighbor cells of cell (r, c): up to 8
+    uint32_t GetNNeighbors(uint32_t r, uint32_t c) const {
+        uint32_t n = 0;
+        for (int32_t dr = -1; dr <= 1; dr++) {
+            for (int32_t dc = -1; dc <= 1; dc++) {
+                if ((dr != 0 || dc != 0) && IsCell(static_cast<int64_t> (r) + dr, static_cast<int64_t> (c) + dc)) {
+                    n++;
+                }
+            }
+        }
+        return n;
+    }
+
+    ConflictGraphTopology ToTopology() const {
+        ConflictGraphTopology topology;
+        for (uint32_t r = 0; r < rows; r++) {
+            for (uint32_t c = 0; c < cols; c++) {
+                ConflictGraphTopology::Cell cell;
+                cell.ap = "A" + GetCellSuffix(r, c);
+                cell.sta = "a" + GetCellSuffix(r, c);
+                std::ostringstream ssid;
+                ssid << "ssid_" << topology.cells.size() + 1;
+                cell.ssid = ssid.str();
+                topology.cells.push_back(cell);
+
+                ConflictGraphTopology::Flow flow;
+                flow.src = cell.ap;
+                flow.dst = cell.sta;
+                flow.dataRate = dataRate;
+                flow.packetSize = packetSize;
+                topology.flows.push_back(flow);
+            }
+        }
+
+        //Own cell, then the neighbors right, below left, below and below right (each pair once)
+        for (uint32_t r = 0; r < rows; r++) {
+            for (uint32_t c = 0; c < cols; c++) {
+                AddConflict(topology, "A" + GetCellSuffix(r, c), "a" + GetCellSuffix(r, c));
+                static const int32_t dr[] = {0, 1, 1, 1};
+                static const int32_t dc[] = {1, -1, 0, 1};
+                for (uint32_t k = 0; k < 4; k++) {
+                    if (!IsCell(static_cast<int64_t> (r) + dr[k], static_cast<int64_t> (c) + dc[k])) {
+                        continue;
+                    }
+                    std::string a = GetCellSuffix(r, c);
+                    std::string b = GetCellSuffix(r + dr[k], c + dc[k]);
+                    AddConflict(topology, "a" + a, "a" + b);
+                    AddConflict(topology, "A" + a, "A" + b);
+                    AddConflict(topology, "a" + a, "A" + b);
+                    AddConflict(topology, "A" + a, "a" + b);
+                }
+            }
+        }
+        topology.Validate();
+        return topology;
+    }
+
+    //Mean flow throughput and starved windows per neighbor count, from a conflict-graph result
+    void AddNeighborSummary(ResultRecord &record) const {
+        std::map<uint32_t, double> throughput;
+        std::map<uint32_t, double> starvedWindows;
+        std::map<uint32_t, uint32_t> flows;
+        for (uint32_t r = 0; r < rows; r++) {
+            for (uint32_t c = 0; c < cols; c++) {
+                std::string flow = "A" + GetCellSuffix(r, c) + "_a" + GetCellSuffix(r, c);
+                uint32_t n = GetNNeighbors(r, c);
+                throughput[n] += record.GetDouble("throughput_" + flow);
+                starvedWindows[n] += record.GetDouble("starvedWindows_" + flow);
+                flows[n]++;
+            }
+        }
+        for (std::map<uint32_t, uint32_t>::const_iterator it = flows.begin(); it != flows.end(); ++it) {
+            std::ostringstream suffix;
+            suffix << "_n" << it->first;
+            record.Set("flows" + suffix.str(), it->second);
+            record.Set("meanThroughput" + suffix.str(), throughput[it->first] / it->second);
+            record.Set("meanStarvedWindows" + suffix.str(), starvedWindows[it->first] / it->second);
+        }
+    }
+
+private:
+    bool IsCell(int64_t r, int64_t c) const {
+        return r >= 0 && c >= 0 && r < rows && c < cols;
+    }
+
+    static void AddConflict(ConflictGraphTopology &topology, const std::string &a, const std::string &b) {
+        ConflictGraphTopology::Conflict conflict;
+        conflict.a = a;
+        conflict.b = b;
+        conflict.loss = 0.0;
+        topology.conflicts.push_back(conflict);
+    }
+};
+
+} // namespace ns3
+
+#endif /* CELL_GRID_H */
@@ -0,0 +1,656 @@
+/* Conflict-graph scenario (Problem1 / Problem2)
+   ---------------------------------------------
+
+   Builds and runs the multi-cell network of a ConflictGraphTopology (see
+   conflict-graph-topology.h for the text format). Node IDs follow the cell
+   order (AP then STA), cell i uses 192.168.<i+1>.0/24 with the AP on .1 and
+   the station on .2, exactly like the original scripts (10.<n/256>.<n%256>.0/24
+   with n = i+1 beyond 254 cells).
+
+   With --decompose the groups of cells that cannot hear each other (see
+   ConflictGraph::GetIndependentCells) are simulated as separate networks in
+   parallel worker processes, and their per-flow results and WINDOW records
+   are merged into those of the whole network. Groups without flows are not
+   simulated at all. Each part runs under its own RngRun (see
+   ConflictGraphPartsJob), so the parts draw independent random streams and
+   the results are statistically, not bit-for-bit, equal to the single
+   simulation.
+*/
+
+#ifndef CONFLICT_GRAPH_SCENARIO_H
+#define CONFLICT_GRAPH_SCENARIO_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/propagation-module.h"
+
+#include "conflict-graph-topology.h"
+#include "conflict-graph.h"
+#include "convergence-stop.h"
+#include "flow-metrics.h"
+#include "light-pcap.h"
+#include "mac-event-recorder.h"
+#include "measurement-window.h"
+#include "node-matrix-propagation-loss-model.h"
+#include "packet-pool.h"
+#include "profiling-scheduler.h"
+#include "replication.h"
+#include "resource-usage.h"
+#include "result-cache.h"
+#include "result-record.h"
+#include "saturated-application.h"
+#include "snapshot.h"
+#include "worker-pool.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct ConflictGraphConfig {
+    double simTime; //Simulator stop time (seconds), upper bound with early stopping
+    std::string pcapPrefix; //Empty: no packet capture, else <prefix>_node_<name>
+    std::string channel; //"shared": one YansWifiChannel, "component": one per audible component, "neighbor": one per transmitter
+    std::string traffic; //"onoff": flows at their data rate, "saturated" (see saturated-application.h)
+    bool packetPool; //Saturated flows resend one pooled packet (see packet-pool.h)
+    CaptureOptions capture;
+    MacEventOptions macEvents; //Per-node MAC/PHY event rings, dumped on a trigger (see mac-event-recorder.h)
+    double metricsInterval; //WINDOW record period in seconds, 0: no windows
+    double starvationShare; //Starved: below this fraction of the fair share
+    ConvergenceOptions convergence; //Early stop once all flow throughputs have settled
+    std::string cacheDir; //Result cache (see result-cache.h), empty: always simulate
+    ProfilingOptions profiling; //Event scheduler and progress reports (see profiling-scheduler.h)
+    WarmupOptions measurement; //Warm-up excluded from the per-flow results (see measurement-window.h)
+    bool decompose; //Simulate independent groups of cells separately and merge the results
+    uint32_t decomposeJobs; //Parts simulated concurrently, 0: one per core
+    int32_t part; //Index of the part being simulated (set by ConflictGraphPartsJob), -1: whole topology
+    SnapshotOptions snapshot; //Variants branched off one warm-up (see snapshot.h)
+
+    ConflictGraphConfig()
+    : simTime(200.0),
+      channel("shared"),
+      traffic("onoff"),
+      packetPool(false),
+      metricsInterval(1.0),
+      starvationShare(0.1),
+      decompose(false),
+      decomposeJobs(0),
+      part(-1) {
+        //Full captures of every node are redundant next to the WINDOW records
+        capture.mode = "auto";
+    }
+
+    void AddToCommandLine(CommandLine &cmd) {
+        cmd.AddValue("simTime", "Simulator stop time in seconds", simTime);
+        cmd.AddValue("pcapPrefix", "Per-node pcap prefix (empty: no capture)", pcapPrefix);
+        cmd.AddValue("channel", "shared: one channel for all nodes, component: one channel per group of nodes that can detect each other, "
+                "neighbor: each transmission reaches only the nodes that can detect it", channel);
+        cmd.AddValue("traffic", "Flow traffic source: onoff or saturated (keeps the MAC queue topped up)", traffic);
+        cmd.AddValue("packetPool", "Send pooled packets instead of allocating one per send (saturated traffic)", packetPool);
+        capture.AddToCommandLine(cmd);
+        macEvents.AddToCommandLine(cmd);
+        cmd.AddValue("metricsInterval", "Per-flow throughput/fairness window in seconds (0: off)", metricsInterval);
+        cmd.AddValue("starvationShare", "A flow below this fraction of the fair share is starved", starvationShare);
+        convergence.AddToCommandLine(cmd);
+        measurement.AddToCommandLine(cmd);
+        profiling.AddToCommandLine(cmd);
+        cmd.AddValue("decompose", "Simulate groups of cells that cannot hear each other in parallel processes", decompose);
+        cmd.AddValue("decomposeJobs", "Number of groups simulated concurrently (0: number of cores)", decomposeJobs);
+        snapshot.AddToCommandLine(cmd);
+        cmd.AddValue("cache", "Result cache directory; a hit skips the simulation, its captures and WINDOW records (empty: off)", cacheDir);
+    }
+
+    ResultRecord ToRecord() const {
+        ResultRecord record;
+        record.Set("simTime", simTime);
+        record.Set("channel", channel);
+        record.Set("traffic", traffic);
+        record.Set("packetPool", packetPool ? 1 : 0);
+        record.Set("decompose", decompose ? 1 : 0);
+        record.Set("metricsInterval", metricsInterval);
+        record.Set("precision", convergence.precision);
+        record.Set("warmupMode", measurement.autoWarmup ? "auto" : (measurement.warmup > 0 ? "fixed" : "none"));
+        if (measurement.IsEnabled()) {
+            record.Set("warmupLimit", measurement.autoWarmup ? measurement.maxWarmup : measurement.warmup);
+        }
+        snapshot.AddToRecord(record);
+        return record;
+    }
+
+    //Result cache key of a topology under this configuration for one RNG run
+    std::string GetCacheKey(const ConflictGraphTopology &topology, uint32_t rngRun) const {
+        ResultRecord key = ToRecord();
+        key.Set("starvationShare", starvationShare);
+        //Estimator settings change where a run stops or starts measuring
+        key.Set("batchTime", convergence.batchTime);
+        key.Set("minBatches", convergence.minBatches);
+        key.Set("autoInterval", measurement.autoInterval);
+        key.Set("autoSamples", measurement.autoSamples);
+        key.Set("autoTolerance", measurement.autoTolerance);
+        if (part >= 0) {
+            key.Set("part", part);
+        }
+        key.Set("topology", topology.ToString());
+        if (!topology.lossFile.empty()) {
+            key.Set("lossFileHash", ResultCache::HashFile(topology.lossFile));
+        }
+        return ResultCache::MakeKey("conflict-graph", key, rngRun);
+    }
+};
+
+//Channel of node i under a channel mode (see SimulateConflictGraph)
+inline uint32_t GetChannelIndex(const std::string &channel, const ConflictGraph &graph, uint32_t i) {
+    if (channel == "component") {
+        return graph.GetComponent(i);
+    }
+    return channel == "neighbor" ? i : 0;
+}
+
+//Build the multi-cell network of the topology, run it and return per-flow results;
+//the WINDOW records of the online flow metrics are streamed to windows (if set)
+inline ResultRecord SimulateConflictGraph(const ConflictGraphTopology &topology, const ConflictGraphConfig &config,
+        std::ostream *windows = 0) {
+    WallClock setupClock; //Setup: everything up to Simulator::Run
+    config.profiling.Install();
+
+    //RTS/CTS activation
+    UintegerValue ctsThreshold = 0;
+    Config::SetDefault("ns3::WifiRemoteStationManager::RtsCtsThreshold", ctsThreshold);
+
+    //Create access point and station node of every cell
+    std::vector<NodeContainer> nodes(topology.GetNNodes());
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        nodes[i].Create(1);
+        // Nodes do not change their positions; the mobility model carries the topology index
+        Ptr<IndexedPositionMobilityModel> mobility = CreateObject<IndexedPositionMobilityModel> ();
+        mobility->SetIndex(i);
+        nodes[i].Get(0)->AggregateObject(mobility);
+    }
+
+    //The propagation loss is fixed for each pair of nodes
+    //and does not depend on their actual positions.
+    Ptr<NodeMatrixPropagationLossModel> propagationLoss = CreateObject<NodeMatrixPropagationLossModel> ();
+    propagationLoss->SetDefaultLoss(topology.defaultLoss);
+    //Dense n x n matrix up to 256 nodes (512 kB), sorted rows of the listed pairs beyond
+    propagationLoss->SetSparse(topology.GetNNodes() > 256);
+    propagationLoss->SetNNodes(topology.GetNNodes());
+    for (uint32_t i = 0; i < topology.conflicts.size(); i++) {
+        //The two nodes are within the transmission range of each other
+        uint32_t a = topology.GetNodeIndex(topology.conflicts[i].a);
+        uint32_t b = topology.GetNodeIndex(topology.conflicts[i].b);
+        propagationLoss->SetLoss(a, b, topology.conflicts[i].loss);
+    }
+    if (!topology.lossFile.empty()) {
+        //Bulk losses by node index override the conflicts
+        propagationLoss->LoadFile(topology.lossFile, topology.lossFormat);
+        if (propagationLoss->GetNNodes() > topology.GetNNodes()) {
+            NS_FATAL_ERROR("Loss file " << topology.lossFile << " has " << propagationLoss->GetNNodes()
+                    << " nodes, the topology " << topology.GetNNodes());
+        }
+    }
+
+    //Create Channels and Phy
+    //YansWifiChannel hands every frame to all PHYs attached to it and Receive
+    //delivers to its own PHY list. In "component" mode each component of the
+    //interference graph gets its own channel: a transmission still reaches every
+    //node of its component, audible or not, so a connected chain gains nothing.
+    //In "neighbor" mode every node transmits on a channel of its own whose PHY
+    //list is the node plus the receivers that can detect it (added after the
+    //install; each PHY still listens through its own channel), so a
+    //transmission schedules one reception per audible neighbor. Both split
+    //modes drop the interference of sub-CCA signals (see conflict-graph.h); the
+    //deliveriesPerTx and audiblePerTx fields of the result show the delivery
+    //cost of a run against the audible pairs.
+    if (config.channel != "shared" && config.channel != "component" && config.channel != "neighbor") {
+        NS_FATAL_ERROR("Unknown channel mode " << config.channel);
+    }
+    ConflictGraph graph = topology.lossFile.empty() ? ConflictGraph(topology)
+            : ConflictGraph(*propagationLoss, topology.GetNNodes());
+    uint32_t nChannels = 1;
+    if (config.channel == "component") {
+        nChannels = graph.GetNComponents();
+    } else if (config.channel == "neighbor") {
+        nChannels = topology.GetNNodes();
+    }
+    //Receptions scheduled per transmission: the other PHYs on the sender's channel
+    double deliveries = 0.0;
+    for (uint32_t i = 0; i < topology.GetNNodes(); i++) {
+        if (config.channel == "shared") {
+            deliveries += topology.GetNNodes() - 1;
+        } else if (config.channel == "component") {
+            deliveries += graph.GetMembers(graph.GetComponent(i)).size() - 1;
+        } else {
+            deliveries += graph.GetNeighbors(i).size();
+        }
+    }
+    std::vector<Ptr<YansWifiChannel> > wifiChannels(nChannels);
+    for (uint32_t i = 0; i < nChannels; i++) {
+        wifiChannels[i] = CreateObject <YansWifiChannel> ();
+        wifiChannels[i]->SetPropagationLossModel(propagationLoss);
+        wifiChannels[i]->SetPropagationDelayModel(CreateObject <ConstantSpeedPropagationDelayModel> ());
+    }
+    YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default();
+
+    //Create WifiHelper and MACHelper
+    WifiHelper wifiHelper = WifiHelper::Default();
+    wifiHelper.SetStandard(WIFI_PHY_STANDARD_80211b);//Setting WiFi Standard to 802.11b
+    wifiHelper.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+            "DataMode", StringValue("DsssRate11Mbps"),
+            "ControlMode", StringValue("DsssRate11Mbps"));//Setting Data rate and Control rate both to 11Mbps
+    NqosWifiMacHelper wifiMacHelper = NqosWifiMacHelper::Default();
+
+    //Create NetDevices: one SSID per cell
+    std::vector<NetDeviceContainer> devices(topology.GetNNodes());
+    for (uint32_t c = 0; c < topology.cells.size(); c++) {
+        Ssid ssid = Ssid(topology.cells[c].ssid);
+        wifiMacHelper.SetType("ns3::ApWifiMac","Ssid", SsidValue(ssid));
+        wifiPhy.SetChannel(wifiChannels[GetChannelIndex(config.channel, graph, 2 * c)]);
+        devices[2 * c] = wifiHelper.Install(wifiPhy, wifiMacHelper, nodes[2 * c]);
+        wifiMacHelper.SetType("ns3::StaWifiMac","Ssid", SsidValue(ssid),"ActiveProbing", BooleanValue(false));
+        wifiPhy.SetChannel(wifiChannels[GetChannelIndex(config.channel, graph, 2 * c + 1)]);
+        devices[2 * c + 1] = wifiHelper.Install(wifiPhy, wifiMacHelper, nodes[2 * c + 1]);
+    }
+    if (config.channel == "neighbor") {
+        //The receivers of node i's channel: node i itself (attached by the install) and its audible neighbors
+        for (uint32_t i = 0; i < devices.size(); i++) {
+            for (uint32_t k = 0; k < graph.GetNeighbors(i).size(); k++) {
+                Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices[graph.GetNeighbors(i)[k]].Get(0));
+                wifiChannels[i]->Add(DynamicCast<YansWifiPhy> (device->GetPhy()));
+            }
+        }
+    }
+    Snapshot snapshot(config.snapshot);
+    MacEventRecorder macEvents(config.macEvents);
+    for (uint32_t i = 0; i < devices.size(); i++) {
+        snapshot.AddDevices(devices[i]);
+        macEvents.Install(devices[i]);
+    }
+
+    //Setting up Internet stack in the nodes
+    InternetStackHelper stack;
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        stack.Install(nodes[i]);
+    }
+
+    //Assign IP Addresses: one /24 per cell
+    Ipv4AddressHelper ipv4AddressHelper;
+    std::vector<Ipv4InterfaceContainer> interfaces(topology.GetNNodes());
+    for (uint32_t c = 0; c < topology.cells.size(); c++) {
+        std::ostringstream base;
+        if (topology.cells.size() <= 254) {
+            base << "192.168." << c + 1 << ".0";
+        } else {
+            base << "10." << (c + 1) / 256 << "." << (c + 1) % 256 << ".0";
+        }
+        ipv4AddressHelper.SetBase(base.str().c_str(), "255.255.255.0");
+        interfaces[2 * c] = ipv4AddressHelper.Assign(devices[2 * c]);
+        interfaces[2 * c + 1] = ipv4AddressHelper.Assign(devices[2 * c + 1]);
+    }
+
+    //UDP flows (dst: UDP Server, src: UDP Client)
+    std::vector<Ptr<UdpServer> > servers;
+    FlowMetrics metrics(config.metricsInterval, config.starvationShare);
+    metrics.SetOutput(windows);
+    ConvergenceStop convergence(config.convergence);
+    MeasurementWindow window(config.snapshot.GetWarmup(config.measurement, 0.2));
+    Ptr<PacketPool> packetPool; //One pool per simulation, shared by all flows
+    if (config.packetPool) {
+        packetPool = Create<PacketPool> ();
+    }
+    for (uint32_t f = 0; f < topology.flows.size(); f++) {
+        const ConflictGraphTopology::Flow &flow = topology.flows[f];
+        uint32_t src = topology.GetNodeIndex(flow.src);
+        uint32_t dst = topology.GetNodeIndex(flow.dst);
+
+        UdpServerHelper udpServer(55555);//UDP Server listens on port 55555
+        ApplicationContainer udpAppl = udpServer.Install(nodes[dst].Get(0));
+        udpAppl.Start(Seconds(0.1));//UDP Server starts at 0.1sec simulation time
+        udpAppl.Stop(Seconds(config.simTime));
+        servers.push_back(DynamicCast<UdpServer> (udpAppl.Get(0)));
+        metrics.AddFlow(ConflictGraphTopology::GetFlowName(flow), servers.back(), flow.packetSize);
+        //Throughputs below 0.1 Mbps (starved flows) count as zero for the stop rule
+        convergence.AddMetric("throughput_" + ConflictGraphTopology::GetFlowName(flow),
+                new ConvergenceStop::ReceivedRateMetric(servers.back(), flow.packetSize, config.convergence.batchTime), 0.1);
+        window.AddServer(servers.back());
+
+        //UDP Client is bound to UDP Server and starts after UDP server has been started
+        snapshot.InstallTrafficSource(ConflictGraphTopology::GetFlowName(flow), config.traffic, nodes[src].Get(0),
+                InetSocketAddress(interfaces[dst].GetAddress(0), 55555), flow.packetSize, flow.dataRate, Seconds(0.2), packetPool);
+        //Idle flows stay out of the windows until a variant enables them
+        std::string name = ConflictGraphTopology::GetFlowName(flow);
+        metrics.SetActive(name, snapshot.IsActive(name));
+    }
+
+    //Packet capture settings (not with snapshots: every variant would write to the same files)
+    CaptureOptions capture = config.capture.Resolve(config.metricsInterval > 0);
+    LightPcapCapture lightPcap(capture);
+    if (!config.pcapPrefix.empty() && capture.IsEnabled() && !snapshot.IsEnabled()) {
+        for (uint32_t i = 0; i < nodes.size(); i++) {
+            std::string prefix = config.pcapPrefix + "_node_" + topology.GetNodeName(i);
+            if (capture.IsLight()) {
+                lightPcap.Enable(prefix, devices[i]);
+            } else {
+                wifiPhy.EnablePcap(prefix, nodes[i].Get(0)->GetId(), 0);
+            }
+        }
+    }
+
+    //Windows start with the UDP clients; convergence batches one batch later or
+    //when the steady-state window opens
+    metrics.Start(0.2);
+    if (window.IsEnabled()) {
+        window.AddStartCallback(MakeCallback(&ConvergenceStop::StartNow, &convergence));
+        window.Start(0.2);
+    } else {
+        convergence.Start(0.2 + config.convergence.batchTime);
+    }
+
+    //Simulator settings
+    Simulator::Stop(Seconds(config.simTime));
+    double setupTime = setupClock.GetElapsed();
+    WallClock runClock;
+    if (snapshot.IsEnabled()) {
+        if (!snapshot.Branch()) {
+            //Parent: every variant has run to the end in its own child
+            ResultRecord record = snapshot.Merge(config.ToRecord(), windows);
+            record.Set("setupTime", setupTime);
+            Simulator::Destroy();
+            return record;
+        }
+        metrics.SetOutput(snapshot.GetWindowOutput());
+        //Child: only the flows sending in this variant are measured
+        for (uint32_t f = 0; f < topology.flows.size(); f++) {
+            std::string name = ConflictGraphTopology::GetFlowName(topology.flows[f]);
+            metrics.SetActive(name, snapshot.IsActive(name));
+            if (!snapshot.IsActive(name)) {
+                convergence.RemoveMetric("throughput_" + name);
+            }
+        }
+        runClock.Restart();
+    }
+    Simulator::Run();
+    double runTime = runClock.GetElapsed();
+    macEvents.Finish();
+    metrics.Finish();
+
+    //Per-flow throughput over the client active time or the measurement window (Mbps = 2^20 bit/s)
+    ResultRecord record = config.ToRecord();
+    record.Set("channels", nChannels);
+    record.Set("deliveriesPerTx", topology.GetNNodes() > 0 ? deliveries / topology.GetNNodes() : 0.0);
+    record.Set("audiblePerTx", graph.GetMeanNeighbors());
+    double stopTime = Simulator::Now().GetSeconds();
+    record.Set("stopTime", stopTime);
+    record.Set("setupTime", setupTime);
+    record.Set("runTime", runTime);
+    record.Set("peakRssKb", GetPeakRssKb());
+    convergence.AddSummary(record);
+    double activeTime = stopTime - 0.2;
+    if (window.IsEnabled()) {
+        window.AddSummary(record);
+        activeTime = window.IsOpen() ? stopTime - window.GetStart() : 0.0;
+    }
+    std::vector<double> throughput;
+    for (uint32_t f = 0; f < topology.flows.size(); f++) {
+        std::string name = ConflictGraphTopology::GetFlowName(topology.flows[f]);
+        if (!snapshot.IsActive(name)) {
+            continue; //Idle or disabled in this variant
+        }
+        uint32_t received = window.IsEnabled() ? window.GetReceived(f) : servers[f]->GetReceived();
+        record.Set("rxPackets_" + name, received);
+        throughput.push_back(activeTime > 0 ? received * topology.flows[f].packetSize * 8.0 / activeTime / 1024 / 1024 : 0.0);
+        record.Set("throughput_" + name, throughput.back());
+    }
+    record.Set("jain", FlowMetrics::JainIndex(throughput));
+    metrics.AddSummary(record);
+
+    Simulator::Destroy();
+    if (snapshot.IsEnabled()) {
+        snapshot.Return(record);
+    }
+
+    return record;
+}
+
+inline ResultRecord RunConflictGraph(const ConflictGraphTopology &topology, const ConflictGraphConfig &config,
+        std::ostream *windows = 0);
+
+//Simulates the parts of a decomposed topology in worker processes and merges their output.
+//Part p of RngRun r runs as RngRun r * parts + p, so the parts draw independent
+//streams (a single part keeps the run).
+class ConflictGraphPartsJob : public WorkerPool::Job {
+public:
+    ConflictGraphPartsJob(const std::vector<ConflictGraphTopology> &parts, const ConflictGraphConfig &config)
+    : m_parts(parts),
+      m_config(config),
+      m_run(RngSeedManager::GetRun()),
+      m_results(parts.size()),
+      m_windows(parts.size()) {
+        m_config.decompose = false;
+    }
+
+    //WINDOW lines followed by the RESULT line of one part
+    std::string Execute(uint32_t index) {
+        std::ostringstream windows;
+        ConflictGraphConfig config = m_config;
+        config.part = index;
+        RngSeedManager::SetRun(m_run * m_parts.size() + index);
+        ResultRecord record = RunConflictGraph(m_parts[index], config, &windows);
+        return windows.str() + record.ToLine() + "\n";
+    }
+
+    void Collect(uint32_t index, bool ok, const std::string &output) {
+        if (!ok) {
+            return;
+        }
+        std::istringstream lines(output);
+        std::string line;
+        while (std::getline(lines, line)) {
+            ResultRecord parsed;
+            if (!ResultRecord::Parse(line, parsed)) {
+                continue;
+            }
+            if (parsed.GetTag() == "WINDOW") {
+                m_windows[index].push_back(parsed);
+            } else {
+                m_results[index] = parsed;
+            }
+        }
+    }
+
+    //The record of the whole topology; the merged WINDOW records go to windows (if set)
+    ResultRecord Merge(const ConflictGraphTopology &topology, const ConflictGraphConfig &config, std::ostream *windows) const {
+        //Full windows covered by every part (parts stopped early end sooner)
+        uint32_t nWindows = m_windows.empty() ? 0 : m_windows[0].size();
+        for (uint32_t p = 0; p < m_windows.size(); p++) {
+            uint32_t full = 0;
+            while (full < m_windows[p].size() && m_windows[p][full].Get("partial") != "1") {
+                full++;
+            }
+            nWindows = std::min<uint32_t> (nWindows, full);
+        }
+        std::map<std::string, uint32_t> starvedWindows;
+        uint32_t anyStarved = 0;
+        for (uint32_t w = 0; w < nWindows; w++) {
+            std::vector<ResultRecord> parts;
+            for (uint32_t p = 0; p < m_windows.size(); p++) {
+                parts.push_back(m_windows[p][w]);
+            }
+            ResultRecord window = FlowMetrics::MergeWindows(parts, config.starvationShare);
+            if (windows != 0) {
+                window.Print(*windows);
+            }
+            std::string starved = window.Get("starved");
+            if (starved != "-") {
+                anyStarved++;
+                std::istringstream names(starved);
+                std::string name;
+                while (std::getline(names, name, ',')) {
+                    starvedWindows[name]++;
+                }
+            }
+        }
+        //The trailing partial window, when all parts stopped at the same time
+        bool partialAligned = !m_windows.empty();
+        for (uint32_t p = 0; p < m_windows.size() && partialAligned; p++) {
+            partialAligned = m_windows[p].size() > nWindows && m_windows[p][nWindows].Get("partial") == "1"
+                    && m_windows[p][nWindows].Get("end") == m_windows[0][nWindows].Get("end");
+        }
+        if (partialAligned && windows != 0) {
+            std::vector<ResultRecord> parts;
+            for (uint32_t p = 0; p < m_windows.size(); p++) {
+                parts.push_back(m_windows[p][nWindows]);
+            }
+            FlowMetrics::MergeWindows(parts, config.starvationShare).Print(*windows);
+        }
+
+        //Sums and extremes over the parts first, then the per-flow fields of each part
+        ResultRecord record = config.ToRecord();
+        double channels = 0.0;
+        double stopTime = 0.0;
+        double setupTime = 0.0;
+        double peakRssKb = 0.0;
+        double converged = 1.0;
+        double batches = 0.0;
+        double warmup = -2.0;
+        double deliveries = 0.0; //Summed over the nodes of all parts
+        double audible = 0.0;
+        double nodes = 0.0;
+        for (uint32_t p = 0; p < m_results.size(); p++) {
+            channels += m_results[p].GetDouble("channels");
+            deliveries += m_results[p].GetDouble("deliveriesPerTx") * m_parts[p].GetNNodes();
+            audible += m_results[p].GetDouble("audiblePerTx") * m_parts[p].GetNNodes();
+            nodes += m_parts[p].GetNNodes();
+            stopTime = std::max(stopTime, m_results[p].GetDouble("stopTime"));
+            setupTime += m_results[p].GetDouble("setupTime");
+            peakRssKb = std::max(peakRssKb, m_results[p].GetDouble("peakRssKb"));
+            converged = std::min(converged, m_results[p].GetDouble("converged"));
+            batches = std::max(batches, m_results[p].GetDouble("batches"));
+            warmup = std::max(warmup, m_results[p].GetDouble("warmup", -1.0));
+        }
+        record.Set("components", m_parts.size());
+        record.Set("channels", channels);
+        record.Set("deliveriesPerTx", nodes > 0 ? deliveries / nodes : 0.0);
+        record.Set("audiblePerTx", nodes > 0 ? audible / nodes : 0.0);
+        record.Set("stopTime", stopTime);
+        record.Set("setupTime", setupTime);
+        record.Set("runTime", 0.0);
+        record.Set("peakRssKb", static_cast<uint64_t> (peakRssKb));
+        record.Set("converged", converged);
+        record.Set("batches", batches);
+        if (config.measurement.IsEnabled()) {
+            record.Set("warmup", warmup);
+        }
+        record.Set("jain", 1.0);
+        record.Set("windows", nWindows);
+        record.Set("starvedWindows", anyStarved);
+        for (uint32_t p = 0; p < m_results.size(); p++) {
+            const ResultRecord::FieldList &fields = m_results[p].GetFields();
+            for (ResultRecord::FieldList::const_iterator it = fields.begin(); it != fields.end(); ++it) {
+                if (!record.Has(it->first)) {
+                    record.Set(it->first, it->second);
+                }
+            }
+        }
+
+        //Flows of groups that were not simulated carry no traffic at all
+        std::vector<double> throughput;
+        for (uint32_t f = 0; f < topology.flows.size(); f++) {
+            std::string name = ConflictGraphTopology::GetFlowName(topology.flows[f]);
+            throughput.push_back(record.GetDouble("throughput_" + name));
+            record.Set("starvedWindows_" + name, starvedWindows[name]);
+        }
+        record.Set("jain", FlowMetrics::JainIndex(throughput));
+        return record;
+    }
+
+private:
+    std::vector<ConflictGraphTopology> m_parts;
+    ConflictGraphConfig m_config;
+    uint64_t m_run; //RngRun of the whole topology
+    std::vector<ResultRecord> m_results;
+    std::vector<std::vector<ResultRecord> > m_windows;
+};
+
+//SimulateConflictGraph on every group of cells that cannot hear the others and
+//carries at least one flow, in parallel; returns the merged per-flow results
+inline ResultRecord SimulateConflictGraphParts(const ConflictGraphTopology &topology, const ConflictGraphConfig &config,
+        std::ostream *windows = 0) {
+    WallClock clock;
+    std::vector<std::vector<uint32_t> > groups = ConflictGraph(topology).GetIndependentCells();
+    std::vector<ConflictGraphTopology> parts;
+    for (uint32_t g = 0; g < groups.size(); g++) {
+        ConflictGraphTopology part = topology.Select(groups[g]);
+        if (!part.flows.empty()) {
+            parts.push_back(part);
+        }
+    }
+
+    ConflictGraphPartsJob job(parts, config);
+    if (parts.size() == 1) {
+        job.Collect(0, true, job.Execute(0));
+    } else {
+        WorkerPool pool(config.decomposeJobs);
+        if (pool.Run(job, parts.size()) > 0) {
+            NS_FATAL_ERROR("Simulation of a part of the topology failed");
+        }
+    }
+    ResultRecord record = job.Merge(topology, config, windows);
+    record.Set("runTime", clock.GetElapsed());
+    return record;
+}
+
+//SimulateConflictGraph (or its decomposed form), unless the result cache already holds the run
+inline ResultRecord RunConflictGraph(const ConflictGraphTopology &topology, const ConflictGraphConfig &config,
+        std::ostream *windows) {
+    ResultCache cache(config.cacheDir);
+    std::string key = cache.IsEnabled() ? config.GetCacheKey(topology, RngSeedManager::GetRun()) : "";
+    ResultRecord record;
+    if (cache.Get(key, record)) {
+        return record;
+    }
+    if (config.decompose && config.snapshot.IsEnabled()) {
+        NS_FATAL_ERROR("--decompose cannot be combined with --snapshot");
+    }
+    if (config.decompose && !topology.lossFile.empty()) {
+        //The split only knows the conflicts of the topology
+        NS_FATAL_ERROR("--decompose cannot be combined with a loss-file topology");
+    }
+    if (config.decompose) {
+        record = SimulateConflictGraphParts(topology, config, windows);
+    } else {
+        record = SimulateConflictGraph(topology, config, windows);
+    }
+    cache.Put(key, record);
+    if (cache.IsEnabled()) {
+        record.Set("cached", 0);
+    }
+    return record;
+}
+
+//RunConflictGraph as one replication (see replication.h), without WINDOW records
+class ConflictGraphReplication : public Replication::Scenario {
+public:
+    ConflictGraphReplication(const ConflictGraphTopology &topology, const ConflictGraphConfig &config)
+    : m_topology(topology),
+      m_config(config) {
+    }
+
+    ResultRecord Run() {
+        return RunConflictGraph(m_topology, m_config);
+    }
+
+private:
+    ConflictGraphTopology m_topology;
+    ConflictGraphConfig m_config;
+};
+
+} // namespace ns3
+
+#endif /* CONFLICT_GRAPH_SCENARIO_H */
@@ -0,0 +1,256 @@
+/* Conflict-graph topology
+   ------------------------
+
+   Multi-cell 802.11b networks described by a compact text topology instead of
+   hand-written SetLoss calls. One directive per line, '#' starts a comment:
+
+     cell <AP> <STA> [ssid]          AP/station pair forming one cell
+     conflict <node> <node> [loss]   pair within range of each other (default 0 dB)
+     flow <src> <dst> [rate] [size]  saturated UDP flow inside a cell (11Mbps, 1024 B)
+     default-loss <dB>               loss between all other pairs (default 200 dB)
+     loss-file <path> [format]       bulk losses by node index, applied after the
+                                     conflicts: "adjacency" (default, "i j loss"
+                                     lines, symmetric) or "matrix" (n rows of n
+                                     losses, row = transmitter); a relative path
+                                     is relative to the topology file
+
+   Example (problem1b, information asymmetry):
+
+     cell A a
+     cell B b
+     conflict a A
+     conflict b B
+     conflict a b
+     flow B b
+     flow A a
+
+   Node index i of a topology is the i-th node created: cell c holds the AP at
+   2c and the station at 2c+1.
+*/
+
+#ifndef CONFLICT_GRAPH_TOPOLOGY_H
+#define CONFLICT_GRAPH_TOPOLOGY_H
+
+#include "ns3/core-module.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct ConflictGraphTopology {
+    struct Cell {
+        std::string ap;
+        std::string sta;
+        std::string ssid;
+    };
+
+    struct Conflict {
+        std::string a;
+        std::string b;
+        double loss; //dB
+    };
+
+    struct Flow {
+        std::string src;
+        std::string dst;
+        std::string dataRate;
+        uint32_t packetSize;
+    };
+
+    std::vector<Cell> cells;
+    std::vector<Conflict> conflicts;
+    std::vector<Flow> flows;
+    double defaultLoss; //dB
+    std::string lossFile; //Empty: no bulk losses
+    std::string lossFormat; //"adjacency" or "matrix"
+
+    ConflictGraphTopology() : defaultLoss(200), lossFormat("adjacency") {
+    }
+
+    uint32_t GetNNodes() const {
+        return 2 * cells.size();
+    }
+
+    //Node index of a name (cell i: AP = 2i, STA = 2i+1), -1 if unknown
+    int32_t GetNodeIndex(const std::string &name) const {
+        //The name index is rebuilt whenever the number of cells changed (cells are
+        //only ever appended); with duplicate names it stays unused
+        if (m_nodeIndex.size() != GetNNodes()) {
+            m_nodeIndex.clear();
+            for (uint32_t i = 0; i < cells.size(); i++) {
+                m_nodeIndex.insert(std::make_pair(cells[i].ap, 2 * i));
+                m_nodeIndex.insert(std::make_pair(cells[i].sta, 2 * i + 1));
+            }
+        }
+        if (m_nodeIndex.size() == GetNNodes()) {
+            std::map<std::string, uint32_t>::const_iterator it = m_nodeIndex.find(name);
+            return it == m_nodeIndex.end() ? -1 : static_cast<int32_t> (it->second);
+        }
+        for (uint32_t i = 0; i < cells.size(); i++) {
+            if (cells[i].ap == name) {
+                return 2 * i;
+            }
+            if (cells[i].sta == name) {
+                return 2 * i + 1;
+            }
+        }
+        return -1;
+    }
+
+    std::string GetNodeName(uint32_t index) const {
+        return index % 2 == 0 ? cells[index / 2].ap : cells[index / 2].sta;
+    }
+
+    static std::string GetFlowName(const Flow &flow) {
+        return flow.src + "_" + flow.dst;
+    }
+
+    //The given cells (in this order) with the conflicts among their nodes and their flows
+    ConflictGraphTopology Select(const std::vector<uint32_t> &cellIndices) const {
+        ConflictGraphTopology selected;
+        selected.defaultLoss = defaultLoss;
+        for (uint32_t i = 0; i < cellIndices.size(); i++) {
+            selected.cells.push_back(cells[cellIndices[i]]);
+        }
+        for (uint32_t i = 0; i < conflicts.size(); i++) {
+            if (selected.GetNodeIndex(conflicts[i].a) >= 0 && selected.GetNodeIndex(conflicts[i].b) >= 0) {
+                selected.conflicts.push_back(conflicts[i]);
+            }
+        }
+        for (uint32_t i = 0; i < flows.size(); i++) {
+            if (selected.GetNodeIndex(flows[i].src) >= 0) {
+                selected.flows.push_back(flows[i]);
+            }
+        }
+        return selected;
+    }
+
+    //Canonical text of the topology in the format above (no comments, defaults spelled out)
+    std::string ToString() const {
+        std::ostringstream os;
+        os.precision(10);
+        os << "default-loss " << defaultLoss << "\n";
+        if (!lossFile.empty()) {
+            os << "loss-file " << lossFile << " " << lossFormat << "\n";
+        }
+        for (uint32_t i = 0; i < cells.size(); i++) {
+            os << "cell " << cells[i].ap << " " << cells[i].sta << " " << cells[i].ssid << "\n";
+        }
+        for (uint32_t i = 0; i < conflicts.size(); i++) {
+            os << "conflict " << conflicts[i].a << " " << conflicts[i].b << " " << conflicts[i].loss << "\n";
+        }
+        for (uint32_t i = 0; i < flows.size(); i++) {
+            os << "flow " << flows[i].src << " " << flows[i].dst << " " << flows[i].dataRate << " " << flows[i].packetSize << "\n";
+        }
+        return os.str();
+    }
+
+    //Parse the text format above; aborts with the offending line on errors
+    static ConflictGraphTopology Parse(std::istream &is) {
+        ConflictGraphTopology topology;
+        std::string line;
+        uint32_t lineNumber = 0;
+        while (std::getline(is, line)) {
+            lineNumber++;
+            std::string::size_type hash = line.find('#');
+            if (hash != std::string::npos) {
+                line.erase(hash);
+            }
+            std::istringstream ls(line);
+            std::vector<std::string> words;
+            std::string word;
+            while (ls >> word) {
+                words.push_back(word);
+            }
+            if (words.empty()) {
+                continue;
+            }
+
+            if (words[0] == "cell" && (words.size() == 3 || words.size() == 4)) {
+                Cell cell;
+                cell.ap = words[1];
+                cell.sta = words[2];
+                std::ostringstream ssid;
+                ssid << "ssid_" << topology.cells.size() + 1;
+                cell.ssid = words.size() == 4 ? words[3] : ssid.str();
+                topology.cells.push_back(cell);
+            } else if (words[0] == "conflict" && (words.size() == 3 || words.size() == 4)) {
+                Conflict conflict;
+                conflict.a = words[1];
+                conflict.b = words[2];
+                conflict.loss = words.size() == 4 ? std::strtod(words[3].c_str(), 0) : 0.0;
+                topology.conflicts.push_back(conflict);
+            } else if (words[0] == "flow" && words.size() >= 3 && words.size() <= 5) {
+                Flow flow;
+                flow.src = words[1];
+                flow.dst = words[2];
+                flow.dataRate = words.size() >= 4 ? words[3] : "11Mbps";
+                flow.packetSize = words.size() == 5 ? std::strtoul(words[4].c_str(), 0, 10) : 1024;
+                topology.flows.push_back(flow);
+            } else if (words[0] == "default-loss" && words.size() == 2) {
+                topology.defaultLoss = std::strtod(words[1].c_str(), 0);
+            } else if (words[0] == "loss-file" && (words.size() == 2 || words.size() == 3)
+                    && (words.size() == 2 || words[2] == "adjacency" || words[2] == "matrix")) {
+                topology.lossFile = words[1];
+                topology.lossFormat = words.size() == 3 ? words[2] : "adjacency";
+            } else {
+                NS_FATAL_ERROR("Topology line " << lineNumber << ": cannot parse \"" << line << "\"");
+            }
+        }
+        topology.Validate();
+        return topology;
+    }
+
+    static ConflictGraphTopology ParseString(const std::string &text) {
+        std::istringstream is(text);
+        return Parse(is);
+    }
+
+    static ConflictGraphTopology LoadFile(const std::string &path) {
+        std::ifstream is(path.c_str());
+        if (!is) {
+            NS_FATAL_ERROR("Cannot open topology file " << path);
+        }
+        ConflictGraphTopology topology = Parse(is);
+        std::string::size_type slash = path.rfind('/');
+        if (!topology.lossFile.empty() && topology.lossFile[0] != '/' && slash != std::string::npos) {
+            topology.lossFile = path.substr(0, slash + 1) + topology.lossFile;
+        }
+        return topology;
+    }
+
+    void Validate() const {
+        std::map<std::string, bool> names;
+        for (uint32_t i = 0; i < cells.size(); i++) {
+            if (names.count(cells[i].ap) || names.count(cells[i].sta) || cells[i].ap == cells[i].sta) {
+                NS_FATAL_ERROR("Topology: duplicate node name in cell " << cells[i].ap << "/" << cells[i].sta);
+            }
+            names[cells[i].ap] = true;
+            names[cells[i].sta] = true;
+        }
+        for (uint32_t i = 0; i < conflicts.size(); i++) {
+            if (GetNodeIndex(conflicts[i].a) < 0 || GetNodeIndex(conflicts[i].b) < 0) {
+                NS_FATAL_ERROR("Topology: conflict " << conflicts[i].a << " " << conflicts[i].b << " names an unknown node");
+            }
+        }
+        for (uint32_t i = 0; i < flows.size(); i++) {
+            int32_t src = GetNodeIndex(flows[i].src);
+            int32_t dst = GetNodeIndex(flows[i].dst);
+            if (src < 0 || dst < 0 || src / 2 != dst / 2 || src == dst) {
+                NS_FATAL_ERROR("Topology: flow " << flows[i].src << "->" << flows[i].dst << " must connect the AP and STA of one cell");
+            }
+        }
+    }
+
+private:
+    mutable std::map<std::string, uint32_t> m_nodeIndex; //Name -> node index, see GetNodeIndex
+};
+
+} // namespace ns3
+
+#endif /* CONFLICT_GRAPH_TOPOLOGY_H */
@@ -0,0 +1,210 @@
+/* Interference graph of a conflict-graph topology
+   -----------------------------------------------
+
+   Which receivers can hear a transmitter at all: node j hears node i if the
+   configured loss between them leaves the received power (transmit power plus
+   the transmit and receive antenna gains, minus the loss) at or above the PHY
+   CCA threshold, i.e. the signal can at least make j's medium busy. Every
+   other pair only produces receptions that the PHY drops on arrival (200 dB
+   default loss: about -182 dBm).
+
+   The graph gives, per transmitter, its audible neighbors (the receiver lists
+   of the "neighbor" channel mode) and the connected components of the
+   network. Nodes in different components can never decode or detect each
+   other, so they can be placed on separate channels, or simulated separately
+   altogether (GetIndependentCells). This is not bit-exact: a dropped signal
+   still adds its power to the interference at the receiver. That is
+   irrelevant far below the noise floor (about -94 dBm for 802.11b), but a
+   pair just under the CCA threshold (loss around 118-130 dB) interferes
+   measurably and is lost by the split.
+
+   A topology with a loss-file is read from the filled loss model instead,
+   scanning all n^2 pairs.
+*/
+
+#ifndef CONFLICT_GRAPH_H
+#define CONFLICT_GRAPH_H
+
+#include "conflict-graph-topology.h"
+#include "node-matrix-propagation-loss-model.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ns3 {
+
+class ConflictGraph {
+public:
+    //Defaults of YansWifiPhy: TxPowerStart/End, TxGain, RxGain and CcaMode1Threshold
+    ConflictGraph(const ConflictGraphTopology &topology, double txPowerDbm = 16.0206, double txGainDb = 1.0,
+            double rxGainDb = 1.0, double ccaThresholdDbm = -99.0)
+    : m_neighbors(topology.GetNNodes()),
+      m_component(topology.GetNNodes()) {
+        //Received power at or above the CCA threshold
+        double detectionThresholdDbm = ccaThresholdDbm - txGainDb - rxGainDb;
+        uint32_t nNodes = topology.GetNNodes();
+
+        bool defaultAudible = txPowerDbm - topology.defaultLoss >= detectionThresholdDbm;
+        if (defaultAudible) {
+            //Everybody hears everybody unless a pair is explicitly attenuated
+            for (uint32_t i = 0; i < nNodes; i++) {
+                for (uint32_t j = 0; j < nNodes; j++) {
+                    if (i != j && IsAudible(topology, i, j, txPowerDbm, detectionThresholdDbm)) {
+                        m_neighbors[i].push_back(j);
+                    }
+                }
+            }
+        } else {
+            //Only listed pairs can be audible: linear in the number of conflicts
+            for (uint32_t c = 0; c < topology.conflicts.size(); c++) {
+                if (txPowerDbm - topology.conflicts[c].loss < detectionThresholdDbm) {
+                    continue;
+                }
+                uint32_t a = topology.GetNodeIndex(topology.conflicts[c].a);
+                uint32_t b = topology.GetNodeIndex(topology.conflicts[c].b);
+                if (a != b) {
+                    m_neighbors[a].push_back(b);
+                    m_neighbors[b].push_back(a);
+                }
+            }
+            for (uint32_t i = 0; i < m_neighbors.size(); i++) {
+                std::sort(m_neighbors[i].begin(), m_neighbors[i].end());
+                m_neighbors[i].erase(std::unique(m_neighbors[i].begin(), m_neighbors[i].end()), m_neighbors[i].end());
+            }
+        }
+        Connect();
+    }
+
+    //Graph of nodes 0..nNodes-1 under the losses of a filled loss model
+    ConflictGraph(const NodeMatrixPropagationLossModel &propagationLoss, uint32_t nNodes, double txPowerDbm = 16.0206,
+            double txGainDb = 1.0, double rxGainDb = 1.0, double ccaThresholdDbm = -99.0)
+    : m_neighbors(nNodes),
+      m_component(nNodes) {
+        double detectionThresholdDbm = ccaThresholdDbm - txGainDb - rxGainDb;
+        for (uint32_t i = 0; i < nNodes; i++) {
+            for (uint32_t j = 0; j < nNodes; j++) {
+                if (i != j && txPowerDbm - propagationLoss.GetLoss(i, j) >= detectionThresholdDbm) {
+                    m_neighbors[i].push_back(j);
+                }
+            }
+        }
+        Connect();
+    }
+
+    //Nodes that can detect a transmission of node i
+    const std::vector<uint32_t> &GetNeighbors(uint32_t i) const {
+        return m_neighbors[i];
+    }
+
+    //Mean number of nodes that can detect a transmission
+    double GetMeanNeighbors() const {
+        double sum = 0.0;
+        for (uint32_t i = 0; i < m_neighbors.size(); i++) {
+            sum += m_neighbors[i].size();
+        }
+        return m_neighbors.empty() ? 0.0 : sum / m_neighbors.size();
+    }
+
+    uint32_t GetNComponents() const {
+        return m_members.size();
+    }
+
+    uint32_t GetComponent(uint32_t node) const {
+        return m_component[node];
+    }
+
+    const std::vector<uint32_t> &GetMembers(uint32_t component) const {
+        return m_members[component];
+    }
+
+    //Groups of cells (indices into topology.cells) that cannot interact: the
+    //components, merged where the AP and station of a cell fall apart. Groups
+    //are ordered by their lowest cell index.
+    std::vector<std::vector<uint32_t> > GetIndependentCells() const {
+        std::vector<uint32_t> parent(m_members.size());
+        for (uint32_t i = 0; i < parent.size(); i++) {
+            parent[i] = i;
+        }
+        uint32_t nCells = m_component.size() / 2;
+        for (uint32_t c = 0; c < nCells; c++) {
+            uint32_t a = Find(parent, m_component[2 * c]);
+            uint32_t b = Find(parent, m_component[2 * c + 1]);
+            if (a != b) {
+                parent[std::max(a, b)] = std::min(a, b);
+            }
+        }
+
+        std::vector<std::vector<uint32_t> > groups;
+        std::vector<int32_t> number(parent.size(), -1);
+        for (uint32_t c = 0; c < nCells; c++) {
+            uint32_t root = Find(parent, m_component[2 * c]);
+            if (number[root] < 0) {
+                number[root] = groups.size();
+                groups.push_back(std::vector<uint32_t> ());
+            }
+            groups[number[root]].push_back(c);
+        }
+        return groups;
+    }
+
+private:
+    //Components of the neighbor lists
+    void Connect() {
+        std::vector<uint32_t> parent(m_neighbors.size());
+        for (uint32_t i = 0; i < parent.size(); i++) {
+            parent[i] = i;
+        }
+
+        //Union-find over the audible pairs
+        for (uint32_t i = 0; i < m_neighbors.size(); i++) {
+            for (uint32_t k = 0; k < m_neighbors[i].size(); k++) {
+                uint32_t a = Find(parent, i);
+                uint32_t b = Find(parent, m_neighbors[i][k]);
+                if (a != b) {
+                    parent[std::max(a, b)] = std::min(a, b);
+                }
+            }
+        }
+
+        //Number the components in order of their lowest node index
+        std::vector<int32_t> number(parent.size(), -1);
+        for (uint32_t i = 0; i < parent.size(); i++) {
+            uint32_t root = Find(parent, i);
+            if (number[root] < 0) {
+                number[root] = m_members.size();
+                m_members.push_back(std::vector<uint32_t> ());
+            }
+            m_component[i] = number[root];
+            m_members[number[root]].push_back(i);
+        }
+    }
+
+    static bool IsAudible(const ConflictGraphTopology &topology, uint32_t i, uint32_t j, double txPowerDbm, double detectionThresholdDbm) {
+        double loss = topology.defaultLoss;
+        std::string a = topology.GetNodeName(i);
+        std::string b = topology.GetNodeName(j);
+        for (uint32_t c = 0; c < topology.conflicts.size(); c++) {
+            const ConflictGraphTopology::Conflict &conflict = topology.conflicts[c];
+            if ((conflict.a == a && conflict.b == b) || (conflict.a == b && conflict.b == a)) {
+                loss = conflict.loss;
+            }
+        }
+        return txPowerDbm - loss >= detectionThresholdDbm;
+    }
+
+    static uint32_t Find(std::vector<uint32_t> &parent, uint32_t i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    std::vector<std::vector<uint32_t> > m_neighbors;
+    std::vector<uint32_t> m_component;
+    std::vector<std::vector<uint32_t> > m_members;
+};
+
+} // namespace ns3
+
+#endif /* CONFLICT_GRAPH_H */
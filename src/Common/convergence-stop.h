@@ -0,0 +1,244 @@
+/* Convergence-based early stopping
+   --------------------------------
+
+   Ends a run as soon as the monitored metrics have settled instead of always
+   running to the configured stop time. Time is cut into batches of batchTime
+   seconds; every metric contributes one value per batch (e.g. the throughput
+   or the collision probability of that batch) and the batch means give a 95%
+   confidence interval of the metric's mean:
+
+     half width = t(0.975, n-1) * s / sqrt(n)     (n batches, s their std dev)
+
+   After at least minBatches batches the simulation is stopped once every
+   metric satisfies half width <= precision * max(|mean|, zero scale). The
+   zero scale of a metric is the magnitude below which its mean counts as
+   zero (e.g. the collision probability of a single station), so the
+   precision stays relative above it. The configured stop time stays the
+   upper bound.
+
+   Batches begin at the time passed to Start(); the first sample there only
+   sets the baseline, so start after the association/ARP transient.
+*/
+
+#ifndef CONVERGENCE_STOP_H
+#define CONVERGENCE_STOP_H
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+#include "mac-counters.h"
+#include "result-record.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct ConvergenceOptions {
+    double precision; //Target relative CI half width, 0: always run to the stop time
+    double batchTime; //seconds
+    uint32_t minBatches;
+
+    ConvergenceOptions()
+    : precision(0.0),
+      batchTime(1.0),
+      minBatches(10) {
+    }
+
+    void AddToCommandLine(CommandLine &cmd) {
+        cmd.AddValue("precision", "Stop once every metric's 95% CI half width is below this fraction of its mean (0: off)", precision);
+        cmd.AddValue("batchTime", "Batch length of the batch-means estimator in seconds", batchTime);
+        cmd.AddValue("minBatches", "Minimum number of batches before stopping early", minBatches);
+    }
+
+    bool IsEnabled() const {
+        return precision > 0 && batchTime > 0;
+    }
+};
+
+class ConvergenceStop {
+public:
+    //Source of one value per batch; NaN: no value for this batch
+    class Metric {
+    public:
+        virtual ~Metric() {
+        }
+
+        virtual double Sample() = 0;
+    };
+
+    //Throughput (Mbps = 2^20 bit/s) received by a UdpServer during the batch
+    class ReceivedRateMetric : public Metric {
+    public:
+        ReceivedRateMetric(Ptr<UdpServer> server, uint32_t packetSize, double batchTime)
+        : m_server(server),
+          m_packetSize(packetSize),
+          m_batchTime(batchTime),
+          m_last(0) {
+        }
+
+        double Sample() {
+            uint32_t received = m_server->GetReceived();
+            double throughput = (received - m_last) * m_packetSize * 8.0 / m_batchTime / 1024 / 1024;
+            m_last = received;
+            return throughput;
+        }
+
+    private:
+        Ptr<UdpServer> m_server;
+        uint32_t m_packetSize;
+        double m_batchTime;
+        uint32_t m_last;
+    };
+
+    //Missed CTS / RTS of the batch
+    class CollisionMetric : public Metric {
+    public:
+        CollisionMetric(const MacCounters &counters)
+        : m_counters(counters),
+          m_lastRts(0),
+          m_lastMissedCts(0) {
+        }
+
+        double Sample() {
+            uint64_t rts = m_counters.GetTotalRts();
+            uint64_t missedCts = m_counters.GetTotalMissedCts();
+            double probability = rts == m_lastRts ? std::numeric_limits<double>::quiet_NaN()
+                    : static_cast<double> (missedCts - m_lastMissedCts) / (rts - m_lastRts);
+            m_lastRts = rts;
+            m_lastMissedCts = missedCts;
+            return probability;
+        }
+
+    private:
+        const MacCounters &m_counters;
+        uint64_t m_lastRts;
+        uint64_t m_lastMissedCts;
+    };
+
+    ConvergenceStop(const ConvergenceOptions &options)
+    : m_options(options),
+      m_batches(0),
+      m_converged(false) {
+    }
+
+    ~ConvergenceStop() {
+        for (uint32_t i = 0; i < m_metrics.size(); i++) {
+            delete m_metrics[i].metric;
+        }
+    }
+
+    //Takes ownership of metric; zeroScale: means below it count as zero (see above)
+    void AddMetric(const std::string &name, Metric *metric, double zeroScale) {
+        Entry entry;
+        entry.name = name;
+        entry.metric = metric;
+        entry.zeroScale = zeroScale;
+        entry.n = 0;
+        entry.sum = 0.0;
+        entry.squares = 0.0;
+        m_metrics.push_back(entry);
+    }
+
+    //Stop tracking a metric, e.g. of a flow that no longer sends
+    void RemoveMetric(const std::string &name) {
+        for (uint32_t i = 0; i < m_metrics.size(); i++) {
+            if (m_metrics[i].name == name) {
+                delete m_metrics[i].metric;
+                m_metrics.erase(m_metrics.begin() + i);
+                return;
+            }
+        }
+    }
+
+    void Start(double start) {
+        if (m_options.IsEnabled() && !m_metrics.empty()) {
+            Simulator::Schedule(Seconds(start), &ConvergenceStop::Batch, this);
+        }
+    }
+
+    //Baseline sample now, e.g. when a measurement window opens
+    void StartNow() {
+        Start(0.0);
+    }
+
+    //Two-sided 95% quantile of Student's t distribution
+    static double StudentT95(uint32_t degrees) {
+        static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+        if (degrees == 0) {
+            return std::numeric_limits<double>::infinity();
+        }
+        if (degrees <= 30) {
+            return table[degrees - 1];
+        }
+        return degrees <= 60 ? 2.000 : (degrees <= 120 ? 1.980 : 1.960);
+    }
+
+    bool HasConverged() const {
+        return m_converged;
+    }
+
+    //Batches, whether the run stopped early and the CI of every metric
+    void AddSummary(ResultRecord &record) const {
+        record.Set("converged", m_converged ? 1 : 0);
+        record.Set("batches", m_batches > 0 ? m_batches - 1 : 0);
+        //Always present (NaN below two batches) so that CSV columns stay aligned
+        for (uint32_t i = 0; i < m_metrics.size(); i++) {
+            record.Set("ci_" + m_metrics[i].name, m_metrics[i].n > 1 ? HalfWidth(m_metrics[i])
+                    : std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        Metric *metric;
+        double zeroScale;
+        uint32_t n;
+        double sum;
+        double squares;
+    };
+
+    static double HalfWidth(const Entry &entry) {
+        double mean = entry.sum / entry.n;
+        double variance = (entry.squares - entry.n * mean * mean) / (entry.n - 1);
+        return StudentT95(entry.n - 1) * std::sqrt(variance > 0 ? variance : 0.0) / std::sqrt(static_cast<double> (entry.n));
+    }
+
+    void Batch() {
+        bool converged = m_batches >= m_options.minBatches;
+        for (uint32_t i = 0; i < m_metrics.size(); i++) {
+            Entry &entry = m_metrics[i];
+            double value = entry.metric->Sample();
+            if (m_batches > 0 && value == value) {
+                entry.n++;
+                entry.sum += value;
+                entry.squares += value * value;
+            }
+            if (entry.n < 2 || HalfWidth(entry) > m_options.precision * std::max(std::fabs(entry.sum / entry.n), entry.zeroScale)) {
+                converged = false;
+            }
+        }
+        m_batches++;
+        if (converged) {
+            m_converged = true;
+            Simulator::Stop();
+            return;
+        }
+        Simulator::Schedule(Seconds(m_options.batchTime), &ConvergenceStop::Batch, this);
+    }
+
+    ConvergenceOptions m_options;
+    std::vector<Entry> m_metrics;
+    uint32_t m_batches; //Including the baseline sample
+    bool m_converged;
+};
+
+} // namespace ns3
+
+#endif /* CONVERGENCE_STOP_H */
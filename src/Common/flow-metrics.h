@@ -0,0 +1,249 @@
+/* Online windowed per-flow metrics
+   --------------------------------
+
+   Samples the packets received by each flow's UdpServer every "interval"
+   simulated seconds and emits one WINDOW record per window:
+
+     WINDOW start=10 end=11 throughput_A_a=4.12 throughput_B_b=0.03 jain=0.507 starved=B_b
+
+   throughput is in Mbps (2^20 bit/s, like the other results), jain is Jain's
+   fairness index over the flows of the window and a flow is starved in a window
+   when it gets less than starvationShare of the fair share (total / flows).
+   Replaces capturing per-node pcaps and post-processing them for starvation.
+
+   Inactive flows (SetActive, e.g. idle or disabled in a snapshot variant) are
+   left out of the windows from then on. Full windows have partial=0.
+   Finish() emits the stretch between the last full window and the end of the
+   run as one more record with partial=1; it is shorter than the interval and
+   not counted in the windows/starvedWindows summary.
+
+   MergeWindows() combines the WINDOW records of separately simulated parts of
+   one network (same interval) into the record the whole network would give.
+*/
+
+#ifndef FLOW_METRICS_H
+#define FLOW_METRICS_H
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+#include "result-record.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class FlowMetrics {
+public:
+    FlowMetrics(double interval = 1.0, double starvationShare = 0.1)
+    : m_interval(interval),
+      m_starvationShare(starvationShare),
+      m_output(0),
+      m_windowStart(0.0),
+      m_begun(false),
+      m_windows(0),
+      m_starvedWindows(0) {
+    }
+
+    void AddFlow(const std::string &name, Ptr<UdpServer> server, uint32_t packetSize) {
+        Flow flow;
+        flow.name = name;
+        flow.server = server;
+        flow.packetSize = packetSize;
+        flow.lastReceived = 0;
+        flow.starvedWindows = 0;
+        flow.active = true;
+        m_flows.push_back(flow);
+    }
+
+    //Leave a flow out of the following windows (or take it back in)
+    void SetActive(const std::string &name, bool active) {
+        for (uint32_t f = 0; f < m_flows.size(); f++) {
+            if (m_flows[f].name == name) {
+                m_flows[f].active = active;
+            }
+        }
+    }
+
+    //Stream the WINDOW records to os (0: only keep the summary)
+    void SetOutput(std::ostream *os) {
+        m_output = os;
+    }
+
+    void Start(double start) {
+        if (m_interval > 0) {
+            m_windowStart = start;
+            Simulator::Schedule(Seconds(start), &FlowMetrics::Begin, this);
+        }
+    }
+
+    //After Simulator::Run: the last, partial window (if the run went past the last full one)
+    void Finish() {
+        if (!m_begun || Simulator::Now().GetSeconds() <= m_windowStart) {
+            return;
+        }
+        std::vector<bool> isStarved;
+        ResultRecord window = MakeWindow(true, isStarved);
+        if (m_output != 0) {
+            window.Print(*m_output);
+        }
+    }
+
+    //Jain's fairness index (sum x)^2 / (n sum x^2); 1 for no traffic at all
+    static double JainIndex(const std::vector<double> &x) {
+        double sum = 0.0;
+        double squares = 0.0;
+        for (uint32_t i = 0; i < x.size(); i++) {
+            sum += x[i];
+            squares += x[i] * x[i];
+        }
+        return squares == 0.0 ? 1.0 : sum * sum / (x.size() * squares);
+    }
+
+    //Flows getting less than starvationShare of the fair share (total / flows)
+    static std::vector<bool> GetStarved(const std::vector<double> &throughput, double starvationShare) {
+        double total = 0.0;
+        for (uint32_t f = 0; f < throughput.size(); f++) {
+            total += throughput[f];
+        }
+        std::vector<bool> starved(throughput.size(), false);
+        for (uint32_t f = 0; f < throughput.size(); f++) {
+            starved[f] = total > 0 && throughput[f] < starvationShare * total / throughput.size();
+        }
+        return starved;
+    }
+
+    //One WINDOW record over the flows of all parts, jain and starved recomputed
+    static ResultRecord MergeWindows(const std::vector<ResultRecord> &parts, double starvationShare) {
+        ResultRecord window("WINDOW");
+        std::vector<std::string> names;
+        std::vector<double> throughput;
+        for (uint32_t p = 0; p < parts.size(); p++) {
+            const ResultRecord::FieldList &fields = parts[p].GetFields();
+            for (ResultRecord::FieldList::const_iterator it = fields.begin(); it != fields.end(); ++it) {
+                if (it->first.compare(0, 11, "throughput_") == 0) {
+                    names.push_back(it->first.substr(11));
+                    throughput.push_back(std::strtod(it->second.c_str(), 0));
+                } else if (it->first == "start" || it->first == "end" || it->first == "partial") {
+                    window.Set(it->first, it->second);
+                }
+            }
+        }
+        for (uint32_t f = 0; f < names.size(); f++) {
+            window.Set("throughput_" + names[f], throughput[f]);
+        }
+        std::vector<bool> starved = GetStarved(throughput, starvationShare);
+        std::string starvedNames;
+        for (uint32_t f = 0; f < names.size(); f++) {
+            if (starved[f]) {
+                starvedNames += (starvedNames.empty() ? "" : ",") + names[f];
+            }
+        }
+        window.Set("jain", JainIndex(throughput));
+        window.Set("starved", starvedNames.empty() ? "-" : starvedNames);
+        return window;
+    }
+
+    //Windows sampled so far and, per flow, how many of them it was starved in
+    void AddSummary(ResultRecord &record) const {
+        record.Set("windows", m_windows);
+        record.Set("starvedWindows", m_starvedWindows);
+        for (uint32_t f = 0; f < m_flows.size(); f++) {
+            if (m_flows[f].active) {
+                record.Set("starvedWindows_" + m_flows[f].name, m_flows[f].starvedWindows);
+            }
+        }
+    }
+
+private:
+    struct Flow {
+        std::string name;
+        Ptr<UdpServer> server;
+        uint32_t packetSize;
+        uint32_t lastReceived;
+        uint32_t starvedWindows;
+        bool active;
+    };
+
+    void Begin() {
+        for (uint32_t f = 0; f < m_flows.size(); f++) {
+            m_flows[f].lastReceived = m_flows[f].server->GetReceived();
+        }
+        m_begun = true;
+        Simulator::Schedule(Seconds(m_interval), &FlowMetrics::Sample, this);
+    }
+
+    void Sample() {
+        std::vector<bool> isStarved;
+        ResultRecord window = MakeWindow(false, isStarved);
+        if (m_output != 0) {
+            window.Print(*m_output);
+        }
+
+        m_windows++;
+        bool anyStarved = false;
+        for (uint32_t f = 0; f < m_flows.size(); f++) {
+            if (isStarved[f]) {
+                m_flows[f].starvedWindows++;
+                anyStarved = true;
+            }
+        }
+        if (anyStarved) {
+            m_starvedWindows++;
+        }
+        Simulator::Schedule(Seconds(m_interval), &FlowMetrics::Sample, this);
+    }
+
+    //WINDOW record of the active flows from the window start to now; the next
+    //window starts now. isStarved is indexed like m_flows (false if inactive)
+    ResultRecord MakeWindow(bool partial, std::vector<bool> &isStarved) {
+        double now = Simulator::Now().GetSeconds();
+        double length = now - m_windowStart;
+        std::vector<uint32_t> active;
+        std::vector<double> throughput;
+        for (uint32_t f = 0; f < m_flows.size(); f++) {
+            uint32_t received = m_flows[f].server->GetReceived();
+            if (m_flows[f].active) {
+                active.push_back(f);
+                throughput.push_back((received - m_flows[f].lastReceived) * m_flows[f].packetSize * 8.0 / length / 1024 / 1024);
+            }
+            m_flows[f].lastReceived = received;
+        }
+        std::vector<bool> starvedActive = GetStarved(throughput, m_starvationShare);
+        isStarved.assign(m_flows.size(), false);
+
+        ResultRecord window("WINDOW");
+        window.Set("start", m_windowStart);
+        window.Set("end", now);
+        window.Set("partial", partial ? 1 : 0);
+        std::string starved;
+        for (uint32_t i = 0; i < active.size(); i++) {
+            const Flow &flow = m_flows[active[i]];
+            window.Set("throughput_" + flow.name, throughput[i]);
+            if (starvedActive[i]) {
+                isStarved[active[i]] = true;
+                starved += (starved.empty() ? "" : ",") + flow.name;
+            }
+        }
+        window.Set("jain", JainIndex(throughput));
+        window.Set("starved", starved.empty() ? "-" : starved);
+        m_windowStart = now;
+        return window;
+    }
+
+    double m_interval; //seconds, 0 disables sampling
+    double m_starvationShare;
+    std::ostream *m_output;
+    std::vector<Flow> m_flows;
+    double m_windowStart;
+    bool m_begun; //Begin() has run
+    uint32_t m_windows; //Full windows
+    uint32_t m_starvedWindows;
+};
+
+} // namespace ns3
+
+#endif /* FLOW_METRICS_H */
@@ -0,0 +1,228 @@
+/* Lightweight pcap capture
+   ------------------------
+
+   Alternative to YansWifiPhyHelper::EnablePcap for long runs where only MAC
+   headers and timing are needed. Frames are taken from the PHY "PhyTxBegin"
+   and "PhyRxEnd" trace sources of each device and written as DLT_IEEE802_11
+   records to "<prefix>-<node>-<device>.pcap", the same names the helper uses.
+
+   Options (all combinable):
+     snapLen     bytes kept per record (the original length is still recorded)
+     headerOnly  keep only the 24 byte MAC header (control frames fit entirely)
+     sample      keep 1 frame out of every N that pass the other filters
+     start/stop  capture time window in seconds (stop 0: until the end)
+     frames      comma list of rts,cts,data,ack,mgt (empty: all frames)
+     async       buffer records in memory and write them from a background
+                 thread (see async-pcap-writer.h)
+     compress    async, streamed through gzip into <name>.pcap.gz
+
+   With async or compress the "full" mode is served by this class too (all
+   frames, 65535 byte snap length), since the helper writes synchronously.
+
+   Mode "auto" (the conflict-graph default) captures nothing while the online
+   flow metrics run and full frames otherwise; see Resolve.
+*/
+
+#ifndef LIGHT_PCAP_H
+#define LIGHT_PCAP_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+
+#include "async-pcap-writer.h"
+#include "list-spec.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct CaptureOptions {
+    std::string mode; //"full": YansWifiPhyHelper pcap, "light": LightPcapCapture, "none", "auto"
+    uint32_t snapLen;
+    bool headerOnly;
+    uint32_t sample;
+    double start; //seconds
+    double stop; //seconds, 0: until the end of the run
+    std::string frames;
+    bool async;
+    bool compress;
+
+    CaptureOptions()
+    : mode("full"),
+      snapLen(65535),
+      headerOnly(false),
+      sample(1),
+      start(0.0),
+      stop(0.0),
+      async(false),
+      compress(false) {
+    }
+
+    void AddToCommandLine(CommandLine &cmd) {
+        cmd.AddValue("pcapMode", "Packet capture: full, light, none or auto (none while WINDOW metrics run, else full)", mode);
+        cmd.AddValue("pcapSnapLen", "light: bytes kept per captured frame", snapLen);
+        cmd.AddValue("pcapHeaderOnly", "light: keep only the MAC header of each frame", headerOnly);
+        cmd.AddValue("pcapSample", "light: keep 1 out of N frames", sample);
+        cmd.AddValue("pcapStart", "light: capture window start in seconds", start);
+        cmd.AddValue("pcapStop", "light: capture window end in seconds (0: end of run)", stop);
+        cmd.AddValue("pcapFrames", "light: comma list of rts,cts,data,ack,mgt (empty: all)", frames);
+        cmd.AddValue("pcapAsync", "Write captures from a background thread", async);
+        cmd.AddValue("pcapCompress", "Write gzip compressed captures from a background thread", compress);
+    }
+
+    //These options with "auto" replaced by the mode it stands for
+    CaptureOptions Resolve(bool metricsEnabled) const {
+        CaptureOptions resolved = *this;
+        if (mode == "auto") {
+            resolved.mode = metricsEnabled ? "none" : "full";
+        }
+        return resolved;
+    }
+
+    bool IsEnabled() const {
+        return mode != "none";
+    }
+
+    //True if LightPcapCapture has to be used instead of YansWifiPhyHelper::EnablePcap
+    bool IsLight() const {
+        if (mode != "full" && mode != "light" && mode != "none") {
+            NS_FATAL_ERROR("Unknown pcap mode " << mode);
+        }
+        return mode == "light" || async || compress;
+    }
+};
+
+class LightPcapCapture {
+public:
+    LightPcapCapture(const CaptureOptions &options)
+    : m_options(options),
+      m_frameMask(0) {
+        if (m_options.mode == "full") {
+            m_options = CaptureOptions();
+            m_options.async = true;
+            m_options.compress = options.compress;
+        }
+        if (m_options.sample == 0) {
+            m_options.sample = 1;
+        }
+        std::vector<std::string> frames = SplitList(m_options.frames);
+        for (uint32_t i = 0; i < frames.size(); i++) {
+            if (frames[i] == "rts") {
+                m_frameMask |= RTS;
+            } else if (frames[i] == "cts") {
+                m_frameMask |= CTS;
+            } else if (frames[i] == "data") {
+                m_frameMask |= DATA;
+            } else if (frames[i] == "ack") {
+                m_frameMask |= ACK;
+            } else if (frames[i] == "mgt") {
+                m_frameMask |= MGT;
+            } else {
+                NS_FATAL_ERROR("Unknown frame type " << frames[i] << " in pcap frame filter");
+            }
+        }
+        if (m_frameMask == 0) {
+            m_frameMask = RTS | CTS | DATA | ACK | MGT | OTHER;
+        }
+    }
+
+    void Enable(std::string prefix, NetDeviceContainer devices) {
+        for (NetDeviceContainer::Iterator i = devices.Begin(); i != devices.End(); ++i) {
+            Enable(prefix, *i);
+        }
+    }
+
+    void Enable(std::string prefix, Ptr<NetDevice> device) {
+        Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice> (device);
+        NS_ASSERT_MSG(wifiDevice != 0, "LightPcapCapture can only be enabled on WifiNetDevices");
+
+        uint32_t snapLen = m_options.headerOnly ? std::min<uint32_t> (m_options.snapLen, 24) : m_options.snapLen;
+        PcapHelper pcapHelper;
+        std::string filename = pcapHelper.GetFilenameFromDevice(prefix, device);
+        Sink sink;
+        if (m_options.async || m_options.compress) {
+            sink.handle = m_writer.Open(filename, snapLen, m_options.compress);
+        } else {
+            sink.file = pcapHelper.CreateFile(filename, std::ios::out, PcapHelper::DLT_IEEE802_11, snapLen);
+        }
+        sink.seen = 0;
+        m_sinks.push_back(sink);
+
+        uint32_t index = m_sinks.size() - 1;
+        wifiDevice->GetPhy()->TraceConnectWithoutContext("PhyTxBegin",
+                MakeBoundCallback(&LightPcapCapture::Capture, this, index));
+        wifiDevice->GetPhy()->TraceConnectWithoutContext("PhyRxEnd",
+                MakeBoundCallback(&LightPcapCapture::Capture, this, index));
+    }
+
+private:
+    enum FrameType {
+        RTS = 1,
+        CTS = 2,
+        DATA = 4,
+        ACK = 8,
+        MGT = 16,
+        OTHER = 32
+    };
+
+    struct Sink {
+        Ptr<PcapFileWrapper> file; //Synchronous writes
+        uint32_t handle; //AsyncPcapWriter file, if file is null
+        uint64_t seen; //Frames that passed the filters, for 1-in-N sampling
+    };
+
+    static uint32_t GetFrameType(Ptr<const Packet> packet) {
+        WifiMacHeader header;
+        if (packet->PeekHeader(header) == 0) {
+            return OTHER;
+        }
+        if (header.IsRts()) {
+            return RTS;
+        }
+        if (header.IsCts()) {
+            return CTS;
+        }
+        if (header.IsAck()) {
+            return ACK;
+        }
+        if (header.IsData()) {
+            return DATA;
+        }
+        if (header.IsMgt()) {
+            return MGT;
+        }
+        return OTHER;
+    }
+
+    static void Capture(LightPcapCapture *self, uint32_t index, Ptr<const Packet> packet) {
+        const CaptureOptions &options = self->m_options;
+        double now = Simulator::Now().GetSeconds();
+        if (now < options.start || (options.stop > 0 && now > options.stop)) {
+            return;
+        }
+        if ((GetFrameType(packet) & self->m_frameMask) == 0) {
+            return;
+        }
+        Sink &sink = self->m_sinks[index];
+        if (sink.seen++ % options.sample != 0) {
+            return;
+        }
+        if (sink.file != 0) {
+            sink.file->Write(Simulator::Now(), packet);
+        } else {
+            self->m_writer.Write(sink.handle, Simulator::Now(), packet);
+        }
+    }
+
+    CaptureOptions m_options;
+    uint32_t m_frameMask;
+    std::vector<Sink> m_sinks;
+    AsyncPcapWriter m_writer; //Flushed and joined when the capture is destroyed
+};
+
+} // namespace ns3
+
+#endif /* LIGHT_PCAP_H */
@@ -0,0 +1,52 @@
+/* Command line list values
+   ------------------------
+
+   "a,b,c" lists and inclusive integer ranges such as "1-4,8,10", used by the
+   drivers to describe sets of points on a single command line option.
+*/
+
+#ifndef LIST_SPEC_H
+#define LIST_SPEC_H
+
+#include <stdint.h>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+//Split "a,b,c" into its items
+inline std::vector<std::string> SplitList(const std::string &spec, char separator = ',') {
+    std::vector<std::string> items;
+    std::stringstream ss(spec);
+    std::string item;
+    while (std::getline(ss, item, separator)) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+//Expand "1-4,8,10" into 1 2 3 4 8 10
+inline std::vector<uint32_t> ParseUintList(const std::string &spec) {
+    std::vector<uint32_t> values;
+    std::vector<std::string> items = SplitList(spec);
+    for (uint32_t i = 0; i < items.size(); i++) {
+        std::string::size_type dash = items[i].find('-');
+        uint32_t first = std::strtoul(items[i].c_str(), 0, 10);
+        uint32_t last = dash == std::string::npos ? first : std::strtoul(items[i].c_str() + dash + 1, 0, 10);
+        for (uint32_t v = first; v <= last; v++) {
+            values.push_back(v);
+            if (v == last) {
+                break; //v++ would wrap around at UINT32_MAX
+            }
+        }
+    }
+    return values;
+}
+
+} // namespace ns3
+
+#endif /* LIST_SPEC_H */
@@ -0,0 +1,110 @@
+/* Per-node RTS / missed CTS counters
+   ----------------------------------
+
+   Counts RTS transmissions (PHY "PhyTxBegin" frames whose MAC header is an RTS)
+   and missed CTS timeouts (remote station manager "MacTxRtsFailed", fired by
+   DcaTxop::MissedCts) directly from the trace sources of each WifiNetDevice.
+
+   This replaces running with NS_LOG=DcaTxop=level_all and grepping the log
+   for "rts" and "missed cts": the collision probability is missedCts / rts.
+*/
+
+#ifndef MAC_COUNTERS_H
+#define MAC_COUNTERS_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+
+#include <vector>
+
+namespace ns3 {
+
+class MacCounters {
+public:
+    struct NodeCounters {
+        uint32_t nodeId;
+        uint64_t rts;
+        uint64_t missedCts;
+    };
+
+    //Attach counters to every WifiNetDevice of the container
+    void Install(NetDeviceContainer devices) {
+        for (NetDeviceContainer::Iterator i = devices.Begin(); i != devices.End(); ++i) {
+            Install(*i);
+        }
+    }
+
+    void Install(Ptr<NetDevice> device) {
+        Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice> (device);
+        NS_ASSERT_MSG(wifiDevice != 0, "MacCounters can only be installed on WifiNetDevices");
+
+        NodeCounters counters;
+        counters.nodeId = device->GetNode()->GetId();
+        counters.rts = 0;
+        counters.missedCts = 0;
+        m_nodes.push_back(counters);
+
+        //The index is bound into the callbacks, so the vector may grow freely
+        uint32_t index = m_nodes.size() - 1;
+        wifiDevice->GetPhy()->TraceConnectWithoutContext("PhyTxBegin",
+                MakeBoundCallback(&MacCounters::PhyTxBegin, this, index));
+        wifiDevice->GetRemoteStationManager()->TraceConnectWithoutContext("MacTxRtsFailed",
+                MakeBoundCallback(&MacCounters::RtsFailed, this, index));
+    }
+
+    uint32_t GetN() const {
+        return m_nodes.size();
+    }
+
+    const NodeCounters &Get(uint32_t i) const {
+        return m_nodes[i];
+    }
+
+    uint64_t GetTotalRts() const {
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < m_nodes.size(); i++) {
+            total += m_nodes[i].rts;
+        }
+        return total;
+    }
+
+    uint64_t GetTotalMissedCts() const {
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < m_nodes.size(); i++) {
+            total += m_nodes[i].missedCts;
+        }
+        return total;
+    }
+
+    //Restart all counts from zero, e.g. at the start of a measurement window
+    void Reset() {
+        for (uint32_t i = 0; i < m_nodes.size(); i++) {
+            m_nodes[i].rts = 0;
+            m_nodes[i].missedCts = 0;
+        }
+    }
+
+    double GetCollisionProbability() const {
+        uint64_t rts = GetTotalRts();
+        return rts == 0 ? 0.0 : static_cast<double> (GetTotalMissedCts()) / rts;
+    }
+
+private:
+    static void PhyTxBegin(MacCounters *self, uint32_t index, Ptr<const Packet> packet) {
+        WifiMacHeader header;
+        if (packet->PeekHeader(header) != 0 && header.IsRts()) {
+            self->m_nodes[index].rts++;
+        }
+    }
+
+    static void RtsFailed(MacCounters *self, uint32_t index, Mac48Address address) {
+        self->m_nodes[index].missedCts++;
+    }
+
+    std::vector<NodeCounters> m_nodes;
+};
+
+} // namespace ns3
+
+#endif /* MAC_COUNTERS_H */
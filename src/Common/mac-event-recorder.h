@@ -0,0 +1,277 @@
+/* MAC event recorder
+   ------------------
+
+   Always-available replacement for NS_LOG=DcaTxop=level_all when chasing a
+   collision anomaly: every WifiNetDevice records its MAC/PHY events into its
+   own fixed-size ring (see mac-event-ring.h) straight from the trace sources,
+   and the rings are dumped to a binary file only when asked:
+
+     --macEvents=4096                 events kept per node (0: off)
+     --macEventsFile=mac-events.bin   dump file, one section appended per dump
+     --macEventsTrigger=end           dump at the end of the run (default)
+     --macEventsTrigger=ctsTimeout:50 dump when the 50th CTS timeout is recorded
+     --macEventsTrigger=none          only on demand
+
+   On demand: MacEventRecorder::Dump(), or kill -USR1 <pid> on a running
+   simulation (the dump is written at the next recorded event). Read a dump
+   with Tools/macEvents.cc.
+
+   Recorded: frames sent (PhyTxBegin) and received (PhyRxEnd) by type, PHY
+   drops (PhyRxDrop), CTS and ACK timeouts (MacTxRtsFailed/MacTxDataFailed),
+   retry-limit drops and MAC queue drops. The ns-3.2x DcaTxop/DcfManager have
+   no trace source for the backoff, so backoff starts cannot be recorded; the
+   timeouts and transmissions bracket them.
+*/
+
+#ifndef MAC_EVENT_RECORDER_H
+#define MAC_EVENT_RECORDER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/wifi-module.h"
+
+#include "mac-event-ring.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+struct MacEventOptions {
+    uint32_t capacity; //Events kept per node, 0: off
+    std::string path;
+    std::string trigger; //"end", "none" or <event>[:count]
+
+    MacEventOptions()
+    : capacity(0),
+      path("mac-events.bin"),
+      trigger("end") {
+    }
+
+    void AddToCommandLine(CommandLine &cmd) {
+        cmd.AddValue("macEvents", "MAC/PHY events kept per node in a ring buffer (0: off)", capacity);
+        cmd.AddValue("macEventsFile", "File the MAC event rings are dumped to (sections are appended)", path);
+        cmd.AddValue("macEventsTrigger", "Dump the MAC event rings at the end, on the count-th <event>[:count] (e.g. ctsTimeout:50) or none", trigger);
+    }
+
+    bool IsEnabled() const {
+        return capacity > 0;
+    }
+};
+
+class MacEventRecorder {
+public:
+    MacEventRecorder(const MacEventOptions &options)
+    : m_options(options),
+      m_triggerType(0),
+      m_triggerCount(1),
+      m_triggerSeen(0) {
+        if (!options.IsEnabled() || options.trigger == "end" || options.trigger == "none") {
+            return;
+        }
+        std::string::size_type colon = options.trigger.find(':');
+        m_triggerType = MacEvent::ParseType(options.trigger.substr(0, colon));
+        if (colon != std::string::npos) {
+            m_triggerCount = std::strtoul(options.trigger.substr(colon + 1).c_str(), 0, 10);
+        }
+        if (m_triggerType == 0 || m_triggerCount == 0) {
+            NS_FATAL_ERROR("Cannot parse MAC event trigger \"" << options.trigger << "\" (end, none or <event>[:count])");
+        }
+    }
+
+    //Attach a ring to every WifiNetDevice of the container (nothing if disabled)
+    void Install(NetDeviceContainer devices) {
+        for (NetDeviceContainer::Iterator i = devices.Begin(); i != devices.End(); ++i) {
+            Install(*i);
+        }
+    }
+
+    void Install(Ptr<NetDevice> device) {
+        if (!m_options.IsEnabled()) {
+            return;
+        }
+        Ptr<WifiNetDevice> wifiDevice = DynamicCast<WifiNetDevice> (device);
+        NS_ASSERT_MSG(wifiDevice != 0, "MacEventRecorder can only be installed on WifiNetDevices");
+        if (m_rings.empty()) {
+            std::signal(SIGUSR1, &MacEventRecorder::RequestDump);
+        }
+        m_rings.push_back(MacEventRing(device->GetNode()->GetId(), m_options.capacity));
+        m_lastDataSequence.push_back(0);
+
+        //The index is bound into the callbacks, so the vector may grow freely
+        uint32_t index = m_rings.size() - 1;
+        Ptr<WifiPhy> phy = wifiDevice->GetPhy();
+        phy->TraceConnectWithoutContext("PhyTxBegin", MakeBoundCallback(&MacEventRecorder::PhyTxBegin, this, index));
+        phy->TraceConnectWithoutContext("PhyRxEnd", MakeBoundCallback(&MacEventRecorder::PhyRxEnd, this, index));
+        phy->TraceConnectWithoutContext("PhyRxDrop", MakeBoundCallback(&MacEventRecorder::PhyRxDrop, this, index));
+        Ptr<WifiRemoteStationManager> manager = wifiDevice->GetRemoteStationManager();
+        manager->TraceConnectWithoutContext("MacTxRtsFailed", MakeBoundCallback(&MacEventRecorder::RtsFailed, this, index));
+        manager->TraceConnectWithoutContext("MacTxDataFailed", MakeBoundCallback(&MacEventRecorder::DataFailed, this, index));
+        manager->TraceConnectWithoutContext("MacTxFinalRtsFailed", MakeBoundCallback(&MacEventRecorder::FinalRtsFailed, this, index));
+        manager->TraceConnectWithoutContext("MacTxFinalDataFailed", MakeBoundCallback(&MacEventRecorder::FinalDataFailed, this, index));
+        wifiDevice->GetMac()->TraceConnectWithoutContext("MacTxDrop", MakeBoundCallback(&MacEventRecorder::QueueDrop, this, index));
+    }
+
+    //Append the current content of all rings to the dump file
+    void Dump(const std::string &reason) {
+        if (m_rings.empty()) {
+            return;
+        }
+        std::vector<char> section = MacEventRing::MakeSection(m_rings, Simulator::Now().GetNanoSeconds(), reason);
+        //One append per section, so processes sharing the file (variants, parts) do not interleave
+        int fd = open(m_options.path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            NS_FATAL_ERROR("Cannot open MAC event dump " << m_options.path);
+        }
+        const char *data = &section[0];
+        size_t left = section.size();
+        while (left > 0) {
+            ssize_t n = write(fd, data, left);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                NS_FATAL_ERROR("Cannot write MAC event dump " << m_options.path);
+            }
+            data += n;
+            left -= n;
+        }
+        close(fd);
+    }
+
+    //End of the run: dump with the "end" trigger
+    void Finish() {
+        if (m_options.trigger == "end") {
+            Dump("end");
+        }
+    }
+
+    uint64_t GetRecorded() const {
+        uint64_t recorded = 0;
+        for (uint32_t i = 0; i < m_rings.size(); i++) {
+            recorded += m_rings[i].GetRecorded();
+        }
+        return recorded;
+    }
+
+private:
+    static volatile sig_atomic_t &GetDumpRequest() {
+        static volatile sig_atomic_t request = 0;
+        return request;
+    }
+
+    //Signal handler: only sets the flag, the dump happens on the simulator thread
+    static void RequestDump(int) {
+        GetDumpRequest() = 1;
+    }
+
+    static uint32_t GetPeer(Mac48Address address) {
+        uint8_t bytes[6];
+        address.CopyTo(bytes);
+        return (static_cast<uint32_t> (bytes[2]) << 24) | (bytes[3] << 16) | (bytes[4] << 8) | bytes[5];
+    }
+
+    //Frame event of type base + frame kind (base: RTS_TX or RTS_RX)
+    void RecordFrame(uint32_t index, uint32_t base, Ptr<const Packet> packet) {
+        WifiMacHeader header;
+        if (packet->PeekHeader(header) == 0) {
+            Record(index, base + (MacEvent::OTHER_TX - MacEvent::RTS_TX), 0, packet->GetSize(), 0);
+            return;
+        }
+        uint32_t kind = MacEvent::OTHER_TX - MacEvent::RTS_TX;
+        uint16_t sequence = 0;
+        if (header.IsRts()) {
+            kind = 0;
+        } else if (header.IsCts()) {
+            kind = MacEvent::CTS_TX - MacEvent::RTS_TX;
+        } else if (header.IsAck()) {
+            kind = MacEvent::ACK_TX - MacEvent::RTS_TX;
+        } else if (header.IsData()) {
+            kind = MacEvent::DATA_TX - MacEvent::RTS_TX;
+            sequence = header.GetSequenceNumber();
+            if (base == MacEvent::RTS_TX) {
+                m_lastDataSequence[index] = sequence;
+            }
+        } else if (header.IsMgt()) {
+            kind = MacEvent::MGT_TX - MacEvent::RTS_TX;
+            sequence = header.GetSequenceNumber();
+        }
+        //Receiver of a sent frame, sender of a received one (unknown for a received CTS/ACK: no addr2)
+        uint32_t peer = 0;
+        if (base == MacEvent::RTS_TX) {
+            peer = GetPeer(header.GetAddr1());
+        } else if (!header.IsCts() && !header.IsAck()) {
+            peer = GetPeer(header.GetAddr2());
+        }
+        Record(index, base + kind, sequence, packet->GetSize(), peer);
+    }
+
+    void Record(uint32_t index, uint32_t type, uint16_t sequence, uint32_t size, uint32_t peer) {
+        MacEventRing &ring = m_rings[index];
+        MacEvent event;
+        event.time = Simulator::Now().GetNanoSeconds();
+        event.node = ring.GetNodeId();
+        event.type = type;
+        event.sequence = sequence;
+        event.size = size;
+        event.peer = peer;
+        ring.Push(event);
+
+        if (type == m_triggerType && ++m_triggerSeen == m_triggerCount) {
+            Dump(m_options.trigger);
+        }
+        if (GetDumpRequest() != 0) {
+            GetDumpRequest() = 0;
+            Dump("signal");
+        }
+    }
+
+    static void PhyTxBegin(MacEventRecorder *self, uint32_t index, Ptr<const Packet> packet) {
+        self->RecordFrame(index, MacEvent::RTS_TX, packet);
+    }
+
+    static void PhyRxEnd(MacEventRecorder *self, uint32_t index, Ptr<const Packet> packet) {
+        self->RecordFrame(index, MacEvent::RTS_RX, packet);
+    }
+
+    static void PhyRxDrop(MacEventRecorder *self, uint32_t index, Ptr<const Packet> packet) {
+        self->Record(index, MacEvent::RX_DROP, 0, packet->GetSize(), 0);
+    }
+
+    static void RtsFailed(MacEventRecorder *self, uint32_t index, Mac48Address address) {
+        self->Record(index, MacEvent::CTS_TIMEOUT, 0, 0, GetPeer(address));
+    }
+
+    static void DataFailed(MacEventRecorder *self, uint32_t index, Mac48Address address) {
+        self->Record(index, MacEvent::ACK_TIMEOUT, self->m_lastDataSequence[index], 0, GetPeer(address));
+    }
+
+    static void FinalRtsFailed(MacEventRecorder *self, uint32_t index, Mac48Address address) {
+        self->Record(index, MacEvent::RTS_RETRY_DROP, 0, 0, GetPeer(address));
+    }
+
+    static void FinalDataFailed(MacEventRecorder *self, uint32_t index, Mac48Address address) {
+        self->Record(index, MacEvent::DATA_RETRY_DROP, self->m_lastDataSequence[index], 0, GetPeer(address));
+    }
+
+    static void QueueDrop(MacEventRecorder *self, uint32_t index, Ptr<const Packet> packet) {
+        self->Record(index, MacEvent::QUEUE_DROP, 0, packet->GetSize(), 0);
+    }
+
+    MacEventOptions m_options;
+    uint32_t m_triggerType; //0: no event trigger
+    uint32_t m_triggerCount;
+    uint32_t m_triggerSeen;
+    std::vector<MacEventRing> m_rings; //One per device
+    std::vector<uint16_t> m_lastDataSequence; //Per device, for ACK timeouts
+};
+
+} // namespace ns3
+
+#endif /* MAC_EVENT_RECORDER_H */
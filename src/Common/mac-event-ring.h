@@ -0,0 +1,242 @@
+/* MAC event rings
+   ---------------
+
+   Fixed-size binary MAC/PHY event records (24 bytes: time, node, event type,
+   sequence number, frame size, peer address) kept in one ring per node. Once a
+   ring is full the oldest record is overwritten, so memory stays at capacity *
+   24 bytes per node however long the run. Recording is a store and an index
+   increment: no allocation, no formatting and no lock (the simulator thread is
+   the only writer; the ring is only read when it is dumped).
+
+   A dump appends one section to a file, written with a single write:
+
+     section   "NSME" u32 version u32 recordSize u32 nodes i64 time(ns)
+               u32 reasonLength, reason, then per node:
+               u32 nodeId u32 count, count records oldest first
+
+   MacEventDump reads the sections back (see Tools/macEvents.cc). The events
+   are recorded by MacEventRecorder (mac-event-recorder.h); this header does
+   not depend on ns-3.
+*/
+
+#ifndef MAC_EVENT_RING_H
+#define MAC_EVENT_RING_H
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct MacEvent {
+    enum Type {
+        RTS_TX = 1,
+        CTS_TX,
+        DATA_TX,
+        ACK_TX,
+        MGT_TX,
+        OTHER_TX,
+        RTS_RX,
+        CTS_RX,
+        DATA_RX,
+        ACK_RX,
+        MGT_RX,
+        OTHER_RX,
+        RX_DROP, //PHY dropped an incoming frame (busy, too weak)
+        CTS_TIMEOUT,
+        ACK_TIMEOUT,
+        RTS_RETRY_DROP, //Frame dropped after the last RTS retry
+        DATA_RETRY_DROP, //Frame dropped after the last data retry
+        QUEUE_DROP, //MAC queue full
+        N_TYPES
+    };
+
+    int64_t time; //Simulation time in ns
+    uint32_t node;
+    uint16_t type;
+    uint16_t sequence; //Of data/management frames; of the last data frame for ACK timeouts
+    uint32_t size; //Frame size in bytes, 0 for timeouts and retry drops
+    uint32_t peer; //Low 4 bytes of the other MAC address (receiver on tx, sender on rx)
+
+    static const char *GetTypeName(uint32_t type) {
+        static const char *names[N_TYPES] = {"unknown",
+            "rtsTx", "ctsTx", "dataTx", "ackTx", "mgtTx", "otherTx",
+            "rtsRx", "ctsRx", "dataRx", "ackRx", "mgtRx", "otherRx",
+            "rxDrop", "ctsTimeout", "ackTimeout", "rtsRetryDrop", "dataRetryDrop", "queueDrop"};
+        return type < N_TYPES ? names[type] : names[0];
+    }
+
+    //Type of a name, 0 if unknown
+    static uint32_t ParseType(const std::string &name) {
+        for (uint32_t type = 1; type < N_TYPES; type++) {
+            if (name == GetTypeName(type)) {
+                return type;
+            }
+        }
+        return 0;
+    }
+
+    //One line in the spirit of the DcaTxop log
+    std::string ToString() const {
+        char peerText[16];
+        std::sprintf(peerText, "%02x:%02x:%02x:%02x", peer >> 24, (peer >> 16) & 0xff, (peer >> 8) & 0xff, peer & 0xff);
+        std::ostringstream os;
+        os << "+" << time / 1e9 << "s node=" << node << " " << GetTypeName(type) << " seq=" << sequence
+                << " size=" << size << " peer=" << peerText;
+        return os.str();
+    }
+};
+
+class MacEventRing {
+public:
+    //capacity is rounded up to a power of two
+    MacEventRing(uint32_t nodeId, uint32_t capacity)
+    : m_nodeId(nodeId),
+      m_next(0) {
+        uint32_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_events.resize(size);
+        m_mask = size - 1;
+    }
+
+    void Push(const MacEvent &event) {
+        m_events[m_next & m_mask] = event;
+        m_next++;
+    }
+
+    uint32_t GetNodeId() const {
+        return m_nodeId;
+    }
+
+    //Events recorded since the start, including overwritten ones
+    uint64_t GetRecorded() const {
+        return m_next;
+    }
+
+    //Events currently held
+    uint32_t GetCount() const {
+        return m_next < m_events.size() ? static_cast<uint32_t> (m_next) : m_events.size();
+    }
+
+    //i-th held event, 0 is the oldest
+    const MacEvent &Get(uint32_t i) const {
+        return m_events[(m_next - GetCount() + i) & m_mask];
+    }
+
+    //Dump section of a set of rings (see the format above)
+    static std::vector<char> MakeSection(const std::vector<MacEventRing> &rings, int64_t time, const std::string &reason) {
+        std::vector<char> section;
+        Put(section, "NSME", 4);
+        Put32(section, 1);
+        Put32(section, sizeof (MacEvent));
+        Put32(section, rings.size());
+        Put(section, &time, sizeof (time));
+        Put32(section, reason.size());
+        Put(section, reason.data(), reason.size());
+        for (uint32_t r = 0; r < rings.size(); r++) {
+            Put32(section, rings[r].GetNodeId());
+            Put32(section, rings[r].GetCount());
+            for (uint32_t i = 0; i < rings[r].GetCount(); i++) {
+                Put(section, &rings[r].Get(i), sizeof (MacEvent));
+            }
+        }
+        return section;
+    }
+
+private:
+    static void Put32(std::vector<char> &buffer, uint32_t value) {
+        Put(buffer, &value, sizeof (value));
+    }
+
+    static void Put(std::vector<char> &buffer, const void *data, size_t size) {
+        const char *bytes = static_cast<const char *> (data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    uint32_t m_nodeId;
+    std::vector<MacEvent> m_events;
+    uint32_t m_mask;
+    uint64_t m_next; //Index of the next write, grows without bound
+};
+
+//Sections of a dump file
+class MacEventDump {
+public:
+    struct Node {
+        uint32_t nodeId;
+        std::vector<MacEvent> events;
+    };
+
+    struct Section {
+        int64_t time; //Simulation time of the dump in ns
+        std::string reason;
+        std::vector<Node> nodes;
+    };
+
+    //error describes a failure; a truncated last section is ignored
+    bool Read(const std::string &path, std::string &error) {
+        std::ifstream input(path.c_str(), std::ios::binary);
+        if (!input) {
+            error = "cannot open " + path;
+            return false;
+        }
+        char magic[4];
+        while (input.read(magic, 4)) {
+            uint32_t version, recordSize, nodes, reasonLength;
+            Section section;
+            bool header = std::memcmp(magic, "NSME", 4) == 0 && Get(input, version) && Get(input, recordSize);
+            if (!header && !m_sections.empty() && input.eof()) {
+                break; //Truncated tail after complete sections
+            }
+            if (!header || version != 1 || recordSize != sizeof (MacEvent)) {
+                error = path + ": not a MAC event dump (or an unknown version)";
+                return false;
+            }
+            if (!Get(input, nodes) || !Get(input, section.time) || !Get(input, reasonLength)) {
+                break;
+            }
+            section.reason.resize(reasonLength);
+            if (reasonLength > 0 && !input.read(&section.reason[0], reasonLength)) {
+                break;
+            }
+            bool complete = true;
+            for (uint32_t n = 0; n < nodes && complete; n++) {
+                Node node;
+                uint32_t count;
+                complete = Get(input, node.nodeId) && Get(input, count);
+                if (complete && count > 0) {
+                    node.events.resize(count);
+                    complete = !input.read(reinterpret_cast<char *> (&node.events[0]), count * sizeof (MacEvent)).fail();
+                }
+                section.nodes.push_back(node);
+            }
+            if (!complete) {
+                break;
+            }
+            m_sections.push_back(section);
+        }
+        return true;
+    }
+
+    const std::vector<Section> &GetSections() const {
+        return m_sections;
+    }
+
+private:
+    template <typename T>
+    static bool Get(std::istream &input, T &value) {
+        return !input.read(reinterpret_cast<char *> (&value), sizeof (value)).fail();
+    }
+
+    std::vector<Section> m_sections;
+};
+
+} // namespace ns3
+
+#endif /* MAC_EVENT_RING_H */
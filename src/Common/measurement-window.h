@@ -0,0 +1,177 @@
+/* Steady-state measurement window
+   -------------------------------
+
+   Excludes the start-up transient (association, ARP, queue fill-up) from the
+   measurements. The window opens after a warm-up period and stays open until
+   the end of the run; everything registered with the window is counted from
+   its start only:
+
+     - UdpServers added with AddServer(): GetReceived() is relative to the start
+     - start callbacks: e.g. MacCounters::Reset, ConvergenceStop::StartNow
+
+   The warm-up is either fixed (--warmup seconds after the clients start) or
+   detected (--autoWarmup): the aggregate received rate is sampled every
+   autoInterval seconds and the window opens once the mean rate of the last
+   autoSamples samples differs by less than autoTolerance from the mean of
+   the autoSamples before them, or after maxWarmup seconds at the latest.
+*/
+
+#ifndef MEASUREMENT_WINDOW_H
+#define MEASUREMENT_WINDOW_H
+
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+#include "result-record.h"
+
+#include <cmath>
+#include <deque>
+#include <vector>
+
+namespace ns3 {
+
+struct WarmupOptions {
+    double warmup; //Fixed warm-up in seconds after the clients start, 0: no window
+    bool autoWarmup; //Detect the end of the transient instead
+    double autoInterval; //Rate sampling period, seconds
+    uint32_t autoSamples; //Samples per compared block
+    double autoTolerance; //Relative difference of the two block means
+    double maxWarmup; //Upper bound of the detected warm-up, seconds
+
+    WarmupOptions()
+    : warmup(0.0),
+      autoWarmup(false),
+      autoInterval(0.5),
+      autoSamples(4),
+      autoTolerance(0.05),
+      maxWarmup(20.0) {
+    }
+
+    void AddToCommandLine(CommandLine &cmd) {
+        cmd.AddValue("warmup", "Warm-up excluded from all measurements, seconds after the clients start (0: none)", warmup);
+        cmd.AddValue("autoWarmup", "Detect the end of the warm-up from the received rate", autoWarmup);
+        cmd.AddValue("maxWarmup", "Upper bound of the detected warm-up in seconds", maxWarmup);
+    }
+
+    bool IsEnabled() const {
+        return warmup > 0 || autoWarmup;
+    }
+};
+
+class MeasurementWindow {
+public:
+    MeasurementWindow(const WarmupOptions &options)
+    : m_options(options),
+      m_start(-1.0),
+      m_clientStart(0.0),
+      m_lastReceived(0) {
+    }
+
+    bool IsEnabled() const {
+        return m_options.IsEnabled();
+    }
+
+    void AddServer(Ptr<UdpServer> server) {
+        m_servers.push_back(server);
+        m_baseline.push_back(0);
+    }
+
+    //Called when the window opens
+    void AddStartCallback(Callback<void> callback) {
+        m_callbacks.push_back(callback);
+    }
+
+    //clientStart: time the traffic starts; the warm-up counts from there
+    void Start(double clientStart) {
+        if (!IsEnabled()) {
+            return;
+        }
+        m_clientStart = clientStart;
+        if (m_options.autoWarmup) {
+            Simulator::Schedule(Seconds(clientStart), &MeasurementWindow::Detect, this);
+        } else {
+            Simulator::Schedule(Seconds(clientStart + m_options.warmup), &MeasurementWindow::Open, this);
+        }
+    }
+
+    bool IsOpen() const {
+        return m_start >= 0;
+    }
+
+    //Window start in seconds, -1 while still warming up
+    double GetStart() const {
+        return m_start;
+    }
+
+    //Packets received by server i since the window opened (0 before)
+    uint32_t GetReceived(uint32_t i) const {
+        return IsOpen() ? m_servers[i]->GetReceived() - m_baseline[i] : 0;
+    }
+
+    void AddSummary(ResultRecord &record) const {
+        record.Set("warmup", IsOpen() ? m_start - m_clientStart : -1.0);
+    }
+
+private:
+    uint32_t GetTotalReceived() const {
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < m_servers.size(); i++) {
+            total += m_servers[i]->GetReceived();
+        }
+        return total;
+    }
+
+    void Open() {
+        m_start = Simulator::Now().GetSeconds();
+        for (uint32_t i = 0; i < m_servers.size(); i++) {
+            m_baseline[i] = m_servers[i]->GetReceived();
+        }
+        for (uint32_t i = 0; i < m_callbacks.size(); i++) {
+            m_callbacks[i]();
+        }
+    }
+
+    //Compare the mean rate of the last two blocks of autoSamples samples
+    void Detect() {
+        uint32_t received = GetTotalReceived();
+        if (Simulator::Now().GetSeconds() > m_clientStart) {
+            m_rates.push_back(received - m_lastReceived);
+        }
+        m_lastReceived = received;
+
+        uint32_t k = m_options.autoSamples;
+        if (m_rates.size() > 2 * k) {
+            m_rates.pop_front();
+        }
+        if (m_rates.size() == 2 * k) {
+            double previous = 0.0;
+            double last = 0.0;
+            for (uint32_t i = 0; i < k; i++) {
+                previous += m_rates[i];
+                last += m_rates[k + i];
+            }
+            if (previous > 0 && std::fabs(last - previous) <= m_options.autoTolerance * previous) {
+                Open();
+                return;
+            }
+        }
+        if (Simulator::Now().GetSeconds() - m_clientStart >= m_options.maxWarmup) {
+            Open();
+            return;
+        }
+        Simulator::Schedule(Seconds(m_options.autoInterval), &MeasurementWindow::Detect, this);
+    }
+
+    WarmupOptions m_options;
+    double m_start;
+    double m_clientStart;
+    std::vector<Ptr<UdpServer> > m_servers;
+    std::vector<uint32_t> m_baseline; //Received count of each server when the window opened
+    std::vector<Callback<void> > m_callbacks;
+    std::deque<uint32_t> m_rates; //Packets per autoInterval, last 2 * autoSamples
+    uint32_t m_lastReceived;
+};
+
+} // namespace ns3
+
+#endif /* MEASUREMENT_WINDOW_H */
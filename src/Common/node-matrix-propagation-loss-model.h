@@ -0,0 +1,321 @@
+/* Node-indexed propagation loss matrix
+   ------------------------------------
+
+   Drop-in replacement for MatrixPropagationLossModel. The loss of every
+   (transmitter, receiver) pair lives in one flat n x n array indexed by node,
+   so the per-reception lookup is an array read instead of a std::map search
+   over pairs of mobility model pointers.
+
+   The index of a mobility model is the "Index" attribute when it is an
+   IndexedPositionMobilityModel (a ConstantPositionMobilityModel carrying its
+   index) and the ID of the node it is aggregated to otherwise. It is resolved
+   once per mobility model and kept in a small pointer-hashed table, so a
+   lookup costs no dynamic_cast or GetObject; the index of a model must not
+   change after its first reception.
+
+   Losses can be loaded in bulk from an adjacency list ("i j loss" per line,
+   symmetric) or from a full matrix (n rows of n values, row = transmitter).
+   Lines starting with '#' are ignored by both loaders. Conflict-graph
+   topologies reach them through the loss-file directive (see
+   conflict-graph-topology.h).
+
+   For large networks where only a few pairs per node differ from the default
+   loss, SetSparse(true) stores each transmitter's pairs in a sorted row
+   instead (memory linear in nodes + pairs, a binary search per lookup).
+*/
+
+#ifndef NODE_MATRIX_PROPAGATION_LOSS_MODEL_H
+#define NODE_MATRIX_PROPAGATION_LOSS_MODEL_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/propagation-module.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+class IndexedPositionMobilityModel : public ConstantPositionMobilityModel {
+public:
+    static TypeId GetTypeId(void) {
+        static TypeId tid = TypeId("ns3::IndexedPositionMobilityModel")
+                .SetParent<ConstantPositionMobilityModel> ()
+                .AddConstructor<IndexedPositionMobilityModel> ()
+                .AddAttribute("Index", "Row/column of this node in a NodeMatrixPropagationLossModel",
+                UintegerValue(0),
+                MakeUintegerAccessor(&IndexedPositionMobilityModel::m_index),
+                MakeUintegerChecker<uint32_t> ());
+        return tid;
+    }
+
+    IndexedPositionMobilityModel() : m_index(0) {
+    }
+
+    uint32_t GetIndex(void) const {
+        return m_index;
+    }
+
+    void SetIndex(uint32_t index) {
+        m_index = index;
+    }
+
+private:
+    uint32_t m_index;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(IndexedPositionMobilityModel);
+
+class NodeMatrixPropagationLossModel : public PropagationLossModel {
+public:
+    static TypeId GetTypeId(void) {
+        static TypeId tid = TypeId("ns3::NodeMatrixPropagationLossModel")
+                .SetParent<PropagationLossModel> ()
+                .AddConstructor<NodeMatrixPropagationLossModel> ()
+                .AddAttribute("DefaultLoss", "The default value for propagation loss, dB.",
+                DoubleValue(std::numeric_limits<double>::max()),
+                MakeDoubleAccessor(&NodeMatrixPropagationLossModel::m_default),
+                MakeDoubleChecker<double> ());
+        return tid;
+    }
+
+    NodeMatrixPropagationLossModel()
+    : m_default(std::numeric_limits<double>::max()),
+      m_nNodes(0),
+      m_sparse(false),
+      m_indexCached(0) {
+    }
+
+    //Switch to sorted per-transmitter rows; call before setting any loss
+    void SetSparse(bool sparse) {
+        NS_ASSERT_MSG(m_nNodes == 0, "SetSparse must be called before the matrix is filled");
+        m_sparse = sparse;
+    }
+
+    void SetDefaultLoss(double defaultLoss) {
+        m_default = defaultLoss;
+    }
+
+    //Preallocate the matrix for indices 0..nNodes-1
+    void SetNNodes(uint32_t nNodes) {
+        if (nNodes <= m_nNodes) {
+            return;
+        }
+        if (m_sparse) {
+            m_rows.resize(nNodes);
+            m_nNodes = nNodes;
+            return;
+        }
+        std::vector<double> loss(static_cast<size_t> (nNodes) * nNodes, Unset());
+        for (uint32_t i = 0; i < m_nNodes; i++) {
+            for (uint32_t j = 0; j < m_nNodes; j++) {
+                loss[static_cast<size_t> (i) * nNodes + j] = m_loss[static_cast<size_t> (i) * m_nNodes + j];
+            }
+        }
+        m_loss.swap(loss);
+        m_nNodes = nNodes;
+    }
+
+    uint32_t GetNNodes(void) const {
+        return m_nNodes;
+    }
+
+    void SetLoss(uint32_t a, uint32_t b, double loss, bool symmetric = true) {
+        SetNNodes(std::max(a, b) + 1);
+        if (m_sparse) {
+            SetRowLoss(a, b, loss);
+            if (symmetric) {
+                SetRowLoss(b, a, loss);
+            }
+            return;
+        }
+        m_loss[static_cast<size_t> (a) * m_nNodes + b] = loss;
+        if (symmetric) {
+            m_loss[static_cast<size_t> (b) * m_nNodes + a] = loss;
+        }
+    }
+
+    //Same signature as MatrixPropagationLossModel::SetLoss
+    void SetLoss(Ptr<MobilityModel> a, Ptr<MobilityModel> b, double loss, bool symmetric = true) {
+        SetLoss(GetIndex(a), GetIndex(b), loss, symmetric);
+    }
+
+    double GetLoss(uint32_t a, uint32_t b) const {
+        if (a >= m_nNodes || b >= m_nNodes) {
+            return m_default;
+        }
+        if (m_sparse) {
+            const Row &row = m_rows[a];
+            Row::const_iterator it = std::lower_bound(row.begin(), row.end(), std::make_pair(b, -std::numeric_limits<double>::max()));
+            return it != row.end() && it->first == b ? it->second : m_default;
+        }
+        double loss = m_loss[static_cast<size_t> (a) * m_nNodes + b];
+        return loss != loss ? m_default : loss;
+    }
+
+    //"i j loss" per line, symmetric; returns the number of pairs read
+    uint32_t LoadAdjacencyList(std::istream &is) {
+        uint32_t pairs = 0;
+        std::string line;
+        while (std::getline(is, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream ls(line);
+            uint32_t a;
+            uint32_t b;
+            double loss;
+            if (!(ls >> a >> b >> loss)) {
+                NS_FATAL_ERROR("Adjacency list: cannot parse \"" << line << "\"");
+            }
+            SetLoss(a, b, loss);
+            pairs++;
+        }
+        return pairs;
+    }
+
+    //n rows of n losses (row: transmitter, column: receiver); returns n
+    uint32_t LoadMatrix(std::istream &is) {
+        std::vector<std::vector<double> > rows;
+        std::string line;
+        while (std::getline(is, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            std::istringstream ls(line);
+            std::vector<double> row;
+            double loss;
+            while (ls >> loss) {
+                row.push_back(loss);
+            }
+            if (!row.empty()) {
+                rows.push_back(row);
+            }
+        }
+        SetNNodes(rows.size());
+        for (uint32_t i = 0; i < rows.size(); i++) {
+            if (rows[i].size() != rows.size()) {
+                NS_FATAL_ERROR("Loss matrix: row " << i << " has " << rows[i].size() << " values, expected " << rows.size());
+            }
+            for (uint32_t j = 0; j < rows.size(); j++) {
+                if (i != j) {
+                    SetLoss(i, j, rows[i][j], false);
+                }
+            }
+        }
+        return rows.size();
+    }
+
+    //format: "adjacency" or "matrix"
+    uint32_t LoadFile(const std::string &path, const std::string &format) {
+        std::ifstream is(path.c_str());
+        if (!is) {
+            NS_FATAL_ERROR("Cannot open loss file " << path);
+        }
+        if (format == "adjacency") {
+            return LoadAdjacencyList(is);
+        }
+        if (format == "matrix") {
+            return LoadMatrix(is);
+        }
+        NS_FATAL_ERROR("Unknown loss file format " << format);
+        return 0;
+    }
+
+private:
+    typedef std::vector<std::pair<uint32_t, double> > Row; //(receiver, loss), sorted by receiver
+
+    void SetRowLoss(uint32_t a, uint32_t b, double loss) {
+        Row &row = m_rows[a];
+        Row::iterator it = std::lower_bound(row.begin(), row.end(), std::make_pair(b, -std::numeric_limits<double>::max()));
+        if (it != row.end() && it->first == b) {
+            it->second = loss;
+        } else {
+            row.insert(it, std::make_pair(b, loss));
+        }
+    }
+
+    static double Unset(void) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    //Index of a mobility model through the cache (open addressing, linear probing)
+    uint32_t GetIndex(Ptr<MobilityModel> mobility) const {
+        const MobilityModel *key = PeekPointer(mobility);
+        size_t mask = m_indexCache.size() - 1;
+        size_t slot = GetSlot(key, mask);
+        while (!m_indexCache.empty() && m_indexCache[slot].first != 0) {
+            if (m_indexCache[slot].first == key) {
+                return m_indexCache[slot].second;
+            }
+            slot = (slot + 1) & mask;
+        }
+        uint32_t index = ResolveIndex(mobility);
+        //Keep the table at most half full
+        if (2 * (m_indexCached + 1) > m_indexCache.size()) {
+            IndexCache cache(std::max<size_t> (64, 2 * m_indexCache.size()), IndexEntry(0, 0));
+            mask = cache.size() - 1;
+            for (size_t i = 0; i < m_indexCache.size(); i++) {
+                if (m_indexCache[i].first != 0) {
+                    size_t s = GetSlot(m_indexCache[i].first, mask);
+                    while (cache[s].first != 0) {
+                        s = (s + 1) & mask;
+                    }
+                    cache[s] = m_indexCache[i];
+                }
+            }
+            m_indexCache.swap(cache);
+            slot = GetSlot(key, mask);
+            while (m_indexCache[slot].first != 0) {
+                slot = (slot + 1) & mask;
+            }
+        }
+        m_indexCache[slot] = IndexEntry(key, index);
+        m_indexCached++;
+        return index;
+    }
+
+    static size_t GetSlot(const MobilityModel *key, size_t mask) {
+        return ((reinterpret_cast<size_t> (key) >> 4) * 2654435761u) & mask;
+    }
+
+    static uint32_t ResolveIndex(Ptr<MobilityModel> mobility) {
+        const IndexedPositionMobilityModel *indexed = dynamic_cast<const IndexedPositionMobilityModel *> (PeekPointer(mobility));
+        if (indexed != 0) {
+            return indexed->GetIndex();
+        }
+        Ptr<Node> node = mobility->GetObject<Node> ();
+        NS_ASSERT_MSG(node != 0, "Mobility model is neither indexed nor aggregated to a node");
+        return node->GetId();
+    }
+
+    virtual double DoCalcRxPower(double txPowerDbm, Ptr<MobilityModel> a, Ptr<MobilityModel> b) const {
+        return txPowerDbm - GetLoss(GetIndex(a), GetIndex(b));
+    }
+
+    virtual int64_t DoAssignStreams(int64_t stream) {
+        return 0;
+    }
+
+    double m_default; //dB
+    uint32_t m_nNodes;
+    std::vector<double> m_loss; //Row-major, NaN: use m_default
+    bool m_sparse;
+    std::vector<Row> m_rows; //Sparse mode: one row per transmitter
+    typedef std::pair<const MobilityModel *, uint32_t> IndexEntry;
+    typedef std::vector<IndexEntry> IndexCache;
+    mutable IndexCache m_indexCache; //Size a power of two, null key: empty slot
+    mutable uint32_t m_indexCached;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(NodeMatrixPropagationLossModel);
+
+} // namespace ns3
+
+#endif /* NODE_MATRIX_PROPAGATION_LOSS_MODEL_H */
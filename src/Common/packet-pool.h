@@ -0,0 +1,59 @@
+/* Pooled packets for fixed-size traffic
+   -------------------------------------
+
+   Every flow of these scenarios sends identical UDP payloads, so the
+   generators do not need a fresh Packet per send. A PacketPool holds one
+   pre-built packet per payload size for the lifetime of a simulation, and
+   Get() hands out that packet again and again.
+
+   This is safe because the UDP socket never modifies the packet it is given:
+   UdpSocketImpl passes a copy-on-write Copy() down the stack (the copy shares
+   the pooled payload buffer until the headers are added), and the only thing
+   it touches on the original is its own don't-fragment packet tag, which it
+   removes before adding it again. The generator side of each send therefore
+   costs no allocation; the stack's own copy is outside the reach of scenario
+   code, as are the packets freed by the receiving UdpServer.
+
+   All packets sent from one pool share the packet uid of the pre-built
+   packet, which only matters for uid based traces (none are used here).
+*/
+
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <map>
+
+namespace ns3 {
+
+class PacketPool : public SimpleRefCount<PacketPool> {
+public:
+    PacketPool()
+    : m_served(0) {
+    }
+
+    //The pooled packet of the given payload size; never modify it
+    Ptr<Packet> Get(uint32_t size) {
+        m_served++;
+        std::map<uint32_t, Ptr<Packet> >::iterator it = m_packets.find(size);
+        if (it == m_packets.end()) {
+            it = m_packets.insert(std::make_pair(size, Create<Packet> (size))).first;
+        }
+        return it->second;
+    }
+
+    //Packets handed out instead of allocated
+    uint64_t GetServed() const {
+        return m_served;
+    }
+
+private:
+    std::map<uint32_t, Ptr<Packet> > m_packets; //Payload size -> pre-built packet
+    uint64_t m_served;
+};
+
+} // namespace ns3
+
+#endif /* PACKET_POOL_H */
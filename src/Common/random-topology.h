@@ -0,0 +1,171 @@
+/* Random conflict-graph topologies
+   --------------------------------
+
+   Samples multi-cell topologies for information-asymmetry studies. Every
+   link is one AP/STA cell carrying one saturated flow (AP -> STA, or STA -> AP
+   with probability "uplink"); its transmitter and receiver always hear each
+   other. Every pair of links interacts with probability "density". An
+   interacting pair is asymmetric with probability "asymmetry": its two
+   transmitters cannot hear each other (hidden), and one or more of the
+   transmitter/receiver and receiver/receiver cross pairs conflict, as between
+   the cells of problem1b/1c. Otherwise the transmitters hear each other and
+   the other cross pairs are drawn at random.
+
+   Graph i of a seed is always the same, independently of the others, so a
+   row of a batch can be reproduced on its own. The interactions of a graph
+   are encoded compactly as "i-j:mask" per interacting pair (links 1-based,
+   '+' separated), mask bits: 1 tx_i/tx_j, 2 tx_i/rx_j, 4 rx_i/tx_j, 8 rx_i/rx_j.
+*/
+
+#ifndef RANDOM_TOPOLOGY_H
+#define RANDOM_TOPOLOGY_H
+
+#include "ns3/core-module.h"
+
+#include "conflict-graph-topology.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct RandomTopologyOptions {
+    uint32_t links; //Cells, one flow each
+    double density; //Probability that two links interact
+    double asymmetry; //Probability that an interacting pair has hidden transmitters
+    double uplink; //Probability that a flow goes STA -> AP
+    uint32_t seed;
+
+    RandomTopologyOptions()
+    : links(4),
+      density(0.5),
+      asymmetry(0.5),
+      uplink(0.0),
+      seed(1) {
+    }
+
+    void AddToCommandLine(CommandLine &cmd) {
+        cmd.AddValue("links", "Links (AP/STA cells with one flow) per graph", links);
+        cmd.AddValue("density", "Probability that two links interact", density);
+        cmd.AddValue("asymmetry", "Probability that interacting links have hidden transmitters", asymmetry);
+        cmd.AddValue("uplink", "Probability that a flow goes from the station to the AP", uplink);
+        cmd.AddValue("seed", "Seed of the graph sampler (independent of RngRun)", seed);
+    }
+};
+
+class RandomTopology {
+public:
+    //Graph index of the sampler seeded with options.seed
+    RandomTopology(const RandomTopologyOptions &options, uint32_t index)
+    : m_interactingPairs(0),
+      m_asymmetricPairs(0) {
+        m_state = (static_cast<uint64_t> (options.seed) << 32) ^ index;
+        for (uint32_t i = 0; i < options.links; i++) {
+            std::ostringstream suffix;
+            suffix << i + 1;
+            ConflictGraphTopology::Cell cell;
+            cell.ap = "A" + suffix.str();
+            cell.sta = "a" + suffix.str();
+            cell.ssid = "ssid_" + suffix.str();
+            m_topology.cells.push_back(cell);
+            AddConflict(cell.ap, cell.sta);
+
+            ConflictGraphTopology::Flow flow;
+            bool uplink = Uniform() < options.uplink;
+            flow.src = uplink ? cell.sta : cell.ap;
+            flow.dst = uplink ? cell.ap : cell.sta;
+            flow.dataRate = "11Mbps";
+            flow.packetSize = 1024;
+            m_topology.flows.push_back(flow);
+        }
+
+        std::ostringstream pairs;
+        for (uint32_t i = 0; i < options.links; i++) {
+            for (uint32_t j = i + 1; j < options.links; j++) {
+                if (Uniform() >= options.density) {
+                    continue;
+                }
+                m_interactingPairs++;
+                uint32_t mask;
+                if (Uniform() < options.asymmetry) {
+                    do {
+                        mask = Bit(2) | Bit(4) | Bit(8);
+                    } while (mask == 0);
+                    m_asymmetricPairs++;
+                } else {
+                    mask = 1 | Bit(2) | Bit(4) | Bit(8);
+                }
+                const ConflictGraphTopology::Flow &a = m_topology.flows[i];
+                const ConflictGraphTopology::Flow &b = m_topology.flows[j];
+                if (mask & 1) {
+                    AddConflict(a.src, b.src);
+                }
+                if (mask & 2) {
+                    AddConflict(a.src, b.dst);
+                }
+                if (mask & 4) {
+                    AddConflict(a.dst, b.src);
+                }
+                if (mask & 8) {
+                    AddConflict(a.dst, b.dst);
+                }
+                pairs << (m_interactingPairs == 1 ? "" : "+") << i + 1 << "-" << j + 1 << ":" << mask;
+            }
+        }
+        m_pairs = pairs.str();
+        m_topology.Validate();
+    }
+
+    const ConflictGraphTopology &GetTopology() const {
+        return m_topology;
+    }
+
+    //Interacting pairs in the encoding above, "-" for none
+    std::string GetPairs() const {
+        return m_pairs.empty() ? "-" : m_pairs;
+    }
+
+    uint32_t GetInteractingPairs() const {
+        return m_interactingPairs;
+    }
+
+    uint32_t GetAsymmetricPairs() const {
+        return m_asymmetricPairs;
+    }
+
+private:
+    //SplitMix64: small, seedable per graph and identical on every platform
+    uint64_t Next() {
+        uint64_t z = (m_state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    double Uniform() {
+        return (Next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    uint32_t Bit(uint32_t bit) {
+        return Uniform() < 0.5 ? bit : 0;
+    }
+
+    void AddConflict(const std::string &a, const std::string &b) {
+        ConflictGraphTopology::Conflict conflict;
+        conflict.a = a;
+        conflict.b = b;
+        conflict.loss = 0.0;
+        m_topology.conflicts.push_back(conflict);
+    }
+
+    uint64_t m_state;
+    ConflictGraphTopology m_topology;
+    std::string m_pairs;
+    uint32_t m_interactingPairs;
+    uint32_t m_asymmetricPairs;
+};
+
+} // namespace ns3
+
+#endif /* RANDOM_TOPOLOGY_H */
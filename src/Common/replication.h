@@ -0,0 +1,225 @@
+/* Statistical replications
+   ------------------------
+
+   Runs K independent replications of a scenario, replication r with RngRun
+   firstRun + r, each in its own forked worker process (see worker-pool.h), and
+   merges their RESULT records into one:
+
+     RESULT replications=10 nWifi=5 ... collisionProbability=0.081 collisionProbability_sd=0.004 collisionProbability_ci=0.0029 ...
+
+   Fields of the scenario configuration are passed through unchanged; every
+   other numeric field becomes its mean, standard deviation (_sd) and 95%
+   confidence interval half width (_ci). Records are merged as they arrive
+   (Welford's running mean/variance), so memory does not grow with K.
+*/
+
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include "ns3/core-module.h"
+
+#include "convergence-stop.h"
+#include "result-record.h"
+#include "worker-pool.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct ReplicationOptions {
+    uint32_t replications; //K, 1: a single run in-process
+    uint32_t firstRun; //RngRun of the first replication, 0: the current RngRun
+    uint32_t jobs; //Concurrent replications, 0: number of cores
+
+    ReplicationOptions()
+    : replications(1),
+      firstRun(0),
+      jobs(0) {
+    }
+
+    void AddToCommandLine(CommandLine &cmd) {
+        cmd.AddValue("replications", "Number of independent replications (distinct RngRun values)", replications);
+        cmd.AddValue("firstRun", "RngRun of the first replication (0: current RngRun)", firstRun);
+        cmd.AddValue("jobs", "Replications simulated concurrently (0: number of cores)", jobs);
+    }
+
+    bool IsEnabled() const {
+        return replications > 1;
+    }
+
+    uint32_t GetFirstRun() const {
+        return firstRun == 0 ? static_cast<uint32_t> (RngSeedManager::GetRun()) : firstRun;
+    }
+};
+
+//Streaming mean / standard deviation / 95% CI of the fields of many records
+class ReplicationStats {
+public:
+    //Fields of fixed (the configuration) are copied to the summary as they are
+    ReplicationStats(const ResultRecord &fixed = ResultRecord())
+    : m_fixed(fixed),
+      m_records(0),
+      m_failed(0) {
+    }
+
+    void Add(const ResultRecord &record) {
+        const ResultRecord::FieldList &fields = record.GetFields();
+        for (uint32_t i = 0; i < fields.size(); i++) {
+            if (m_fixed.Has(fields[i].first)) {
+                continue;
+            }
+            Field &field = GetField(fields[i].first, fields[i].second);
+            const char *begin = fields[i].second.c_str();
+            char *end;
+            double value = std::strtod(begin, &end);
+            if (!field.numeric || end == begin || *end != '\0') {
+                field.numeric = false;
+                continue;
+            }
+            field.n++;
+            double delta = value - field.mean;
+            field.mean += delta / field.n;
+            field.m2 += delta * (value - field.mean);
+        }
+        m_records++;
+    }
+
+    void AddFailure() {
+        m_failed++;
+    }
+
+    uint32_t GetN() const {
+        return m_records;
+    }
+
+    ResultRecord GetSummary() const {
+        ResultRecord summary;
+        summary.Set("replications", m_records);
+        summary.Set("failedReplications", m_failed); //Always, so that later CSV columns do not shift
+        summary.Merge(m_fixed);
+        for (uint32_t i = 0; i < m_fields.size(); i++) {
+            const Field &field = m_fields[i];
+            if (!field.numeric) {
+                summary.Set(field.key, field.first);
+                continue;
+            }
+            double sd = field.n > 1 ? std::sqrt(field.m2 / (field.n - 1)) : 0.0;
+            summary.Set(field.key, field.mean);
+            summary.Set(field.key + "_sd", sd);
+            //Always present (0 for a single value) so that CSV columns stay aligned
+            summary.Set(field.key + "_ci", field.n > 1 ? ConvergenceStop::StudentT95(field.n - 1) * sd / std::sqrt(static_cast<double> (field.n)) : 0.0);
+        }
+        return summary;
+    }
+
+private:
+    struct Field {
+        std::string key;
+        std::string first; //Value of the first record, kept for text fields
+        bool numeric;
+        uint32_t n;
+        double mean;
+        double m2; //Sum of squared deviations from the running mean
+    };
+
+    Field &GetField(const std::string &key, const std::string &value) {
+        for (uint32_t i = 0; i < m_fields.size(); i++) {
+            if (m_fields[i].key == key) {
+                return m_fields[i];
+            }
+        }
+        Field field;
+        field.key = key;
+        field.first = value;
+        field.numeric = true;
+        field.n = 0;
+        field.mean = 0.0;
+        field.m2 = 0.0;
+        m_fields.push_back(field);
+        return m_fields.back();
+    }
+
+    ResultRecord m_fixed;
+    std::vector<Field> m_fields;
+    uint32_t m_records;
+    uint32_t m_failed;
+};
+
+class Replication {
+public:
+    //One simulation run; called in the worker after RngRun has been set
+    class Scenario {
+    public:
+        virtual ~Scenario() {
+        }
+
+        virtual ResultRecord Run() = 0;
+    };
+
+    //runs: if set, also receives every replication's record tagged RUN with its rngRun
+    Replication(const ReplicationOptions &options, std::ostream *runs = 0)
+    : m_options(options),
+      m_runs(runs) {
+    }
+
+    //Run all replications and return the merged record (fixed: configuration fields)
+    ResultRecord Run(Scenario &scenario, const ResultRecord &fixed) {
+        ReplicationJob job(scenario, fixed, m_options.GetFirstRun(), m_runs);
+        WorkerPool pool(m_options.jobs);
+        pool.Run(job, m_options.replications);
+        return job.GetStats().GetSummary();
+    }
+
+private:
+    class ReplicationJob : public WorkerPool::Job {
+    public:
+        ReplicationJob(Scenario &scenario, const ResultRecord &fixed, uint32_t firstRun, std::ostream *runs)
+        : m_scenario(scenario),
+          m_stats(fixed),
+          m_firstRun(firstRun),
+          m_runs(runs) {
+        }
+
+        std::string Execute(uint32_t index) {
+            RngSeedManager::SetRun(m_firstRun + index);
+            return m_scenario.Run().ToLine() + "\n";
+        }
+
+        void Collect(uint32_t index, bool ok, const std::string &output) {
+            ResultRecord record;
+            if (!ok || !ResultRecord::Parse(output, record)) {
+                std::cerr << "Replication: RngRun " << m_firstRun + index << " failed" << std::endl;
+                m_stats.AddFailure();
+                return;
+            }
+            m_stats.Add(record);
+            if (m_runs != 0) {
+                ResultRecord run("RUN");
+                run.Set("rngRun", m_firstRun + index);
+                run.Merge(record);
+                run.Print(*m_runs);
+            }
+        }
+
+        const ReplicationStats &GetStats() const {
+            return m_stats;
+        }
+
+    private:
+        Scenario &m_scenario;
+        ReplicationStats m_stats;
+        uint32_t m_firstRun;
+        std::ostream *m_runs;
+    };
+
+    ReplicationOptions m_options;
+    std::ostream *m_runs;
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_H */
@@ -0,0 +1,54 @@
+/* Process resource usage
+   ----------------------
+
+   Wall clock stopwatch and peak resident set size of the current process, for
+   reporting the setup/run cost of a simulation next to its results.
+*/
+
+#ifndef RESOURCE_USAGE_H
+#define RESOURCE_USAGE_H
+
+#include <stdint.h>
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+namespace ns3 {
+
+//Seconds since construction (or the last Restart)
+class WallClock {
+public:
+    WallClock() {
+        Restart();
+    }
+
+    void Restart() {
+        m_start = Now();
+    }
+
+    double GetElapsed() const {
+        return Now() - m_start;
+    }
+
+    static double Now() {
+        struct timeval tv;
+        gettimeofday(&tv, 0);
+        return tv.tv_sec + tv.tv_usec * 1e-6;
+    }
+
+private:
+    double m_start;
+};
+
+//Peak resident set size of this process in kB (Linux ru_maxrss unit)
+inline uint64_t GetPeakRssKb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return usage.ru_maxrss;
+}
+
+} // namespace ns3
+
+#endif /* RESOURCE_USAGE_H */
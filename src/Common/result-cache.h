@@ -0,0 +1,198 @@
+/* Content-addressed result cache
+   ------------------------------
+
+   Stores the RESULT record of a run under a 64-bit key (16 hex digits) derived
+   from everything that determines the outcome:
+
+     - the scenario name and its configuration (config.ToRecord(), topology)
+     - every attribute default changed with Config::SetDefault or --ns3::...
+     - the global values (RngSeed, ...) and the RNG run number
+     - the version of the code: content of the running executable plus size and
+       modification time of the ns-3 libraries it has loaded
+
+   Each entry is one file <dir>/<key>.res holding the record line, written to a
+   temporary file and renamed, so concurrent writers never leave partial
+   entries. Rebuilding the binary or ns-3 changes every key, i.e. invalidates
+   the cache; stale entries are simply never read again (rm -r <dir> to drop
+   them).
+
+   A hit has cached=1 and zero setupTime/runTime (nothing was simulated, the
+   stored wall times belong to the run that filled the entry); the Run*
+   functions mark fresh runs cached=0 while the cache is enabled.
+*/
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "ns3/core-module.h"
+
+#include "result-record.h"
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+class ResultCache {
+public:
+    //dir empty: disabled, Get() always misses and Put() does nothing
+    ResultCache(const std::string &dir = "")
+    : m_dir(dir) {
+        if (!m_dir.empty()) {
+            mkdir(m_dir.c_str(), 0755);
+        }
+    }
+
+    bool IsEnabled() const {
+        return !m_dir.empty();
+    }
+
+    //Key of a run; rngRun replaces the current RngRun global value
+    static std::string MakeKey(const std::string &scenario, const ResultRecord &config, uint32_t rngRun) {
+        std::ostringstream os;
+        os << "scenario " << scenario << "\n";
+        os << "config " << config.ToLine() << "\n";
+        os << "rngRun " << rngRun << "\n";
+        os << GetEnvironment();
+        char key[17];
+        std::sprintf(key, "%016llx", static_cast<unsigned long long> (Hash(os.str())));
+        return key;
+    }
+
+    bool Get(const std::string &key, ResultRecord &record) const {
+        if (!IsEnabled()) {
+            return false;
+        }
+        std::ifstream is(GetPath(key).c_str());
+        std::string line;
+        if (!std::getline(is, line) || !ResultRecord::Parse(line, record)) {
+            return false;
+        }
+        if (record.Has("setupTime")) {
+            record.Set("setupTime", 0.0);
+        }
+        if (record.Has("runTime")) {
+            record.Set("runTime", 0.0);
+        }
+        record.Set("cached", 1);
+        return true;
+    }
+
+    void Put(const std::string &key, const ResultRecord &record) const {
+        if (!IsEnabled()) {
+            return;
+        }
+        std::ostringstream tmp;
+        tmp << GetPath(key) << ".tmp." << getpid();
+        {
+            std::ofstream os(tmp.str().c_str());
+            os << record.ToLine() << "\n";
+            if (!os) {
+                std::remove(tmp.str().c_str());
+                return;
+            }
+        }
+        std::rename(tmp.str().c_str(), GetPath(key).c_str());
+    }
+
+    //Hash of a file's content (16 hex digits), for keys depending on an input file
+    static std::string HashFile(const std::string &path) {
+        uint64_t hash = Hash("");
+        std::ifstream is(path.c_str(), std::ios::binary);
+        char buffer[65536];
+        while (is.read(buffer, sizeof(buffer)) || is.gcount() > 0) {
+            hash = Hash(std::string(buffer, is.gcount()), hash);
+        }
+        char text[17];
+        std::sprintf(text, "%016llx", static_cast<unsigned long long> (hash));
+        return text;
+    }
+
+private:
+    //64-bit FNV-1a
+    static uint64_t Hash(const std::string &data, uint64_t hash = 14695981039346656037ULL) {
+        for (std::string::size_type i = 0; i < data.size(); i++) {
+            hash ^= static_cast<uint8_t> (data[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    //Changed attribute defaults, global values and code version (computed once per process)
+    static const std::string &GetEnvironment() {
+        static std::string environment;
+        if (!environment.empty()) {
+            return environment;
+        }
+        std::ostringstream os;
+        for (uint32_t i = 0; i < TypeId::GetRegisteredN(); i++) {
+            TypeId tid = TypeId::GetRegistered(i);
+            for (uint32_t j = 0; j < tid.GetAttributeN(); j++) {
+                TypeId::AttributeInformation info = tid.GetAttribute(j);
+                std::string value = info.initialValue->SerializeToString(info.checker);
+                if (value != info.originalInitialValue->SerializeToString(info.checker)) {
+                    os << "default " << tid.GetName() << "::" << info.name << "=" << value << "\n";
+                }
+            }
+        }
+        for (GlobalValue::Iterator i = GlobalValue::Begin(); i != GlobalValue::End(); ++i) {
+            if ((*i)->GetName() == "RngRun") {
+                continue;
+            }
+            Ptr<AttributeValue> value = (*i)->GetChecker()->Create();
+            (*i)->GetValue(*value);
+            os << "global " << (*i)->GetName() << "=" << value->SerializeToString((*i)->GetChecker()) << "\n";
+        }
+        os << "binary " << GetCodeVersion() << "\n";
+        environment = os.str();
+        return environment;
+    }
+
+    //Hash of the executable content and of the identity of the loaded ns-3 libraries
+    static std::string GetCodeVersion() {
+        uint64_t hash = Hash("");
+        std::ifstream exe("/proc/self/exe", std::ios::binary);
+        char buffer[65536];
+        while (exe.read(buffer, sizeof(buffer)) || exe.gcount() > 0) {
+            hash = Hash(std::string(buffer, exe.gcount()), hash);
+        }
+
+        std::ifstream maps("/proc/self/maps");
+        std::set<std::string> libraries;
+        std::string line;
+        while (std::getline(maps, line)) {
+            std::string::size_type slash = line.find('/');
+            if (slash != std::string::npos && line.find("libns3", slash) != std::string::npos) {
+                libraries.insert(line.substr(slash));
+            }
+        }
+        for (std::set<std::string>::const_iterator i = libraries.begin(); i != libraries.end(); ++i) {
+            struct stat info;
+            if (stat(i->c_str(), &info) == 0) {
+                std::ostringstream os;
+                os << *i << " " << info.st_size << " " << info.st_mtime << "\n";
+                hash = Hash(os.str(), hash);
+            }
+        }
+        char version[17];
+        std::sprintf(version, "%016llx", static_cast<unsigned long long> (hash));
+        return version;
+    }
+
+    std::string GetPath(const std::string &key) const {
+        return m_dir + "/" + key + ".res";
+    }
+
+    std::string m_dir;
+};
+
+} // namespace ns3
+
+#endif /* RESULT_CACHE_H */
@@ -0,0 +1,142 @@
+/* Machine-readable result record
+   ------------------------------
+
+   One line of whitespace separated key=value pairs, prefixed by a tag:
+
+     RESULT nWifi=10 rts=207357 missedCts=58911 collisionProbability=0.284104
+
+   The scenario binaries print their measurements in this form so that scripts
+   can pick them up with a single grep instead of parsing NS_LOG output.
+   Keys keep the order in which they were first set.
+*/
+
+#ifndef RESULT_RECORD_H
+#define RESULT_RECORD_H
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+class ResultRecord {
+public:
+    typedef std::vector<std::pair<std::string, std::string> > FieldList;
+
+    ResultRecord(const std::string &tag = "RESULT") : m_tag(tag) {
+    }
+
+    const std::string &GetTag() const {
+        return m_tag;
+    }
+
+    void SetTag(const std::string &tag) {
+        m_tag = tag;
+    }
+
+    //Set a field; an existing key keeps its position and gets the new value
+    void Set(const std::string &key, const std::string &value) {
+        std::string clean = value;
+        for (std::string::size_type i = 0; i < clean.size(); i++) {
+            if (clean[i] == ' ' || clean[i] == '\t' || clean[i] == '\n') {
+                clean[i] = '_';
+            }
+        }
+        for (FieldList::iterator it = m_fields.begin(); it != m_fields.end(); ++it) {
+            if (it->first == key) {
+                it->second = clean;
+                return;
+            }
+        }
+        m_fields.push_back(std::make_pair(key, clean));
+    }
+
+    void Set(const std::string &key, const char *value) {
+        Set(key, std::string(value));
+    }
+
+    template <typename T>
+    void Set(const std::string &key, const T &value) {
+        std::ostringstream os;
+        os.precision(10);
+        os << value;
+        Set(key, os.str());
+    }
+
+    bool Has(const std::string &key) const {
+        for (FieldList::const_iterator it = m_fields.begin(); it != m_fields.end(); ++it) {
+            if (it->first == key) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string Get(const std::string &key, const std::string &fallback = "") const {
+        for (FieldList::const_iterator it = m_fields.begin(); it != m_fields.end(); ++it) {
+            if (it->first == key) {
+                return it->second;
+            }
+        }
+        return fallback;
+    }
+
+    double GetDouble(const std::string &key, double fallback = 0.0) const {
+        if (!Has(key)) {
+            return fallback;
+        }
+        return std::strtod(Get(key).c_str(), 0);
+    }
+
+    const FieldList &GetFields() const {
+        return m_fields;
+    }
+
+    //Append all fields of another record (existing keys are overwritten)
+    void Merge(const ResultRecord &other) {
+        for (FieldList::const_iterator it = other.m_fields.begin(); it != other.m_fields.end(); ++it) {
+            Set(it->first, it->second);
+        }
+    }
+
+    std::string ToLine() const {
+        std::string line = m_tag;
+        for (FieldList::const_iterator it = m_fields.begin(); it != m_fields.end(); ++it) {
+            line += " " + it->first + "=" + it->second;
+        }
+        return line;
+    }
+
+    void Print(std::ostream &os) const {
+        os << ToLine() << std::endl;
+    }
+
+    //Parse a line produced by ToLine(); returns false for anything else
+    static bool Parse(const std::string &line, ResultRecord &record) {
+        std::istringstream is(line);
+        std::string token;
+        if (!(is >> token) || token.find('=') != std::string::npos) {
+            return false;
+        }
+        record = ResultRecord(token);
+        while (is >> token) {
+            std::string::size_type eq = token.find('=');
+            if (eq == std::string::npos || eq == 0) {
+                return false;
+            }
+            record.Set(token.substr(0, eq), token.substr(eq + 1));
+        }
+        return true;
+    }
+
+private:
+    std::string m_tag;
+    FieldList m_fields;
+};
+
+} // namespace ns3
+
+#endif /* RESULT_RECORD_H */
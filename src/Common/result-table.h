@@ -0,0 +1,578 @@
+/* Columnar binary result tables
+   -----------------------------
+
+   Binary counterpart of the RESULT/WINDOW/RUN lines (see result-record.h) for
+   analysis over many runs. A table file is a header followed by blocks; a
+   block holds the rows of one tag with one field list (its schema), stored
+   column by column:
+
+     file    "NSRT" u32 version
+     block   "BLK1" u32 rows u32 columns u32 tagLength u64 blockSize, tag,
+             per column: u32 nameLength, name, u32 type, u64 offset,
+             padding to 8 bytes, then the column data at the offsets
+     F64     rows doubles
+     STR     rows+1 u32 offsets into the characters that follow
+
+   Integers and doubles are in host byte order and every column starts on an
+   8-byte boundary of the file, so a reader maps the file and uses the columns
+   in place (ResultTable, and the standalone reader Tools/resultTable.cc). A
+   column is F64 when every value of the block is a number, STR otherwise.
+
+   ResultTableWriter buffers rows per tag and appends a block every
+   rowsPerBlock rows, when the fields of a tag change and when it is closed;
+   reopening a file appends further blocks. A truncated last block (a run that
+   was killed while writing) is ignored by the reader and cut off by the next
+   writer before it appends. The reader also stops at a block whose columns do
+   not lie inside it.
+
+   The header does not depend on ns-3, so the reader tool builds with a plain
+   C++ compiler.
+*/
+
+#ifndef RESULT_TABLE_H
+#define RESULT_TABLE_H
+
+#include "result-record.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <stdint.h>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+//Memory-mapped table: the columns point into the file mapping
+class ResultTable {
+public:
+    enum Type {
+        F64 = 0,
+        STR = 1
+    };
+
+    struct Column {
+        std::string name;
+        uint32_t type;
+        uint32_t rows;
+        const char *data;
+
+        //The values of an F64 column in place, 0 for STR
+        const double *GetDoubles() const {
+            return type == F64 ? reinterpret_cast<const double *> (data) : 0;
+        }
+
+        double GetDouble(uint32_t row) const {
+            if (type == F64) {
+                return GetDoubles()[row];
+            }
+            return std::strtod(GetString(row).c_str(), 0);
+        }
+
+        std::string GetString(uint32_t row) const {
+            if (type == F64) {
+                ResultRecord format;
+                format.Set("value", GetDoubles()[row]);
+                return format.Get("value");
+            }
+            const uint32_t *offsets = reinterpret_cast<const uint32_t *> (data);
+            const char *text = data + (rows + 1) * sizeof (uint32_t);
+            return std::string(text + offsets[row], offsets[row + 1] - offsets[row]);
+        }
+    };
+
+    struct Block {
+        std::string tag;
+        uint32_t rows;
+        std::vector<Column> columns;
+
+        //0 if the block has no such column
+        const Column *Find(const std::string &name) const {
+            for (uint32_t c = 0; c < columns.size(); c++) {
+                if (columns[c].name == name) {
+                    return &columns[c];
+                }
+            }
+            return 0;
+        }
+
+        //One row as a text record, like the line it was written from
+        ResultRecord GetRecord(uint32_t row) const {
+            ResultRecord record(tag);
+            for (uint32_t c = 0; c < columns.size(); c++) {
+                record.Set(columns[c].name, columns[c].GetString(row));
+            }
+            return record;
+        }
+    };
+
+    ResultTable()
+    : m_data(0),
+      m_size(0),
+      m_end(0) {
+    }
+
+    ~ResultTable() {
+        Close();
+    }
+
+    //Map a table file; error describes a failure
+    bool Open(const std::string &path, std::string &error) {
+        Close();
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            error = path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size < 8) {
+            close(fd);
+            error = path + ": not a result table";
+            return false;
+        }
+        void *data = mmap(0, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (data == MAP_FAILED) {
+            error = path + ": " + std::strerror(errno);
+            return false;
+        }
+        m_data = static_cast<const char *> (data);
+        m_size = info.st_size;
+        if (std::memcmp(m_data, "NSRT", 4) != 0 || Get32(4) != 1) {
+            Close();
+            error = path + ": not a result table (or an unknown version)";
+            return false;
+        }
+
+        uint64_t at = 8;
+        uint64_t size;
+        Block block;
+        while (ParseBlock(at, block, size)) {
+            m_blocks.push_back(block);
+            at += size;
+        }
+        m_end = at;
+        return true;
+    }
+
+    void Close() {
+        if (m_data != 0) {
+            munmap(const_cast<char *> (m_data), m_size);
+        }
+        m_data = 0;
+        m_size = 0;
+        m_end = 0;
+        m_blocks.clear();
+    }
+
+    const std::vector<Block> &GetBlocks() const {
+        return m_blocks;
+    }
+
+    //End of the last complete block; anything after it is a truncated or corrupt tail
+    uint64_t GetEnd() const {
+        return m_end;
+    }
+
+    uint64_t GetRows(const std::string &tag = "") const {
+        uint64_t rows = 0;
+        for (uint32_t b = 0; b < m_blocks.size(); b++) {
+            if (tag.empty() || m_blocks[b].tag == tag) {
+                rows += m_blocks[b].rows;
+            }
+        }
+        return rows;
+    }
+
+private:
+    //Not copyable: the columns point into this mapping
+    ResultTable(const ResultTable &);
+    ResultTable &operator=(const ResultTable &);
+
+    //Block at offset at, false unless it is complete and every column lies inside it
+    bool ParseBlock(uint64_t at, Block &block, uint64_t &size) const {
+        if (at + 24 > m_size || std::memcmp(m_data + at, "BLK1", 4) != 0) {
+            return false;
+        }
+        size = Get64(at + 16);
+        uint64_t end = at + size;
+        uint32_t tagLength = Get32(at + 12);
+        if (size < 24 || size % 8 != 0 || size > m_size - at || 24 + static_cast<uint64_t> (tagLength) > size) {
+            return false;
+        }
+        block = Block();
+        block.rows = Get32(at + 4);
+        block.tag = GetText(at + 24, tagLength);
+        uint32_t columns = Get32(at + 8);
+        uint64_t field = at + 24 + tagLength;
+        for (uint32_t c = 0; c < columns; c++) {
+            if (field + 4 > end || field + 4 + Get32(field) + 12 > end) {
+                return false;
+            }
+            Column column;
+            column.name = GetText(field + 4, Get32(field));
+            field += 4 + column.name.size();
+            column.type = Get32(field);
+            column.rows = block.rows;
+            uint64_t offset = Get64(field + 4);
+            field += 12;
+            if (offset % 8 != 0 || offset < field - at || !HasColumnData(column.type, block.rows, at + offset, end)) {
+                return false;
+            }
+            column.data = m_data + at + offset;
+            block.columns.push_back(column);
+        }
+        return true;
+    }
+
+    //F64: rows doubles, STR: rows+1 non-decreasing offsets and their characters, all before end
+    bool HasColumnData(uint32_t type, uint32_t rows, uint64_t at, uint64_t end) const {
+        if (type == F64) {
+            return at + static_cast<uint64_t> (rows) * sizeof (double) <= end;
+        }
+        uint64_t text = at + (static_cast<uint64_t> (rows) + 1) * sizeof (uint32_t);
+        if (type != STR || text > end || Get32(at) != 0) {
+            return false;
+        }
+        for (uint32_t r = 0; r < rows; r++) {
+            if (Get32(at + 4 * (r + 1)) < Get32(at + 4 * r)) {
+                return false;
+            }
+        }
+        return text + Get32(at + 4 * static_cast<uint64_t> (rows)) <= end;
+    }
+
+    uint32_t Get32(uint64_t at) const {
+        uint32_t value;
+        std::memcpy(&value, m_data + at, sizeof (value));
+        return value;
+    }
+
+    uint64_t Get64(uint64_t at) const {
+        uint64_t value;
+        std::memcpy(&value, m_data + at, sizeof (value));
+        return value;
+    }
+
+    std::string GetText(uint64_t at, uint32_t length) const {
+        return std::string(m_data + at, length);
+    }
+
+    const char *m_data;
+    uint64_t m_size;
+    uint64_t m_end;
+    std::vector<Block> m_blocks;
+};
+
+class ResultTableWriter {
+public:
+    ResultTableWriter(const std::string &path, uint32_t rowsPerBlock = 1024)
+    : m_path(path),
+      m_rowsPerBlock(rowsPerBlock > 0 ? rowsPerBlock : 1) {
+        m_fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (m_fd < 0) {
+            std::perror(("ResultTable: " + path).c_str());
+            return;
+        }
+        struct stat info;
+        if (fstat(m_fd, &info) != 0) {
+            Fail("cannot stat");
+        } else if (info.st_size == 0) {
+            std::vector<char> header;
+            PutBytes(header, "NSRT", 4);
+            Put32(header, 1);
+            if (!WriteAll(header)) {
+                Fail("cannot write the header");
+            }
+        } else {
+            //Drop a block cut off by a killed run, or new blocks would follow the torn one
+            ResultTable existing;
+            std::string error;
+            if (!existing.Open(path, error)) {
+                Fail("not a result table");
+            } else if (existing.GetEnd() < static_cast<uint64_t> (info.st_size)) {
+                std::cerr << "ResultTable: " << path << ": dropping " << info.st_size - existing.GetEnd()
+                        << " bytes of an incomplete block" << std::endl;
+                if (ftruncate(m_fd, existing.GetEnd()) != 0) {
+                    Fail("cannot drop the incomplete block");
+                }
+            }
+        }
+    }
+
+    ~ResultTableWriter() {
+        Close();
+    }
+
+    bool IsOpen() const {
+        return m_fd >= 0;
+    }
+
+    void Add(const ResultRecord &record) {
+        if (m_fd < 0) {
+            return;
+        }
+        const ResultRecord::FieldList &fields = record.GetFields();
+        Pending &pending = m_pending[record.GetTag()];
+        if (!pending.rows.empty() && !HasFields(pending, fields)) {
+            WriteBlock(record.GetTag(), pending);
+        }
+        if (pending.rows.empty()) {
+            pending.names.clear();
+            for (uint32_t i = 0; i < fields.size(); i++) {
+                pending.names.push_back(fields[i].first);
+            }
+        }
+        pending.rows.push_back(std::vector<std::string> ());
+        for (uint32_t i = 0; i < fields.size(); i++) {
+            pending.rows.back().push_back(fields[i].second);
+        }
+        if (pending.rows.size() >= m_rowsPerBlock) {
+            WriteBlock(record.GetTag(), pending);
+        }
+    }
+
+    //Write the buffered rows of every tag
+    void Flush() {
+        for (std::map<std::string, Pending>::iterator it = m_pending.begin(); it != m_pending.end(); ++it) {
+            if (!it->second.rows.empty()) {
+                WriteBlock(it->first, it->second);
+            }
+        }
+    }
+
+    void Close() {
+        if (m_fd < 0) {
+            return;
+        }
+        Flush();
+        close(m_fd);
+        m_fd = -1;
+    }
+
+    static void Put32(std::vector<char> &buffer, uint32_t value) {
+        PutBytes(buffer, &value, sizeof (value));
+    }
+
+    static void Put64(std::vector<char> &buffer, uint64_t value) {
+        PutBytes(buffer, &value, sizeof (value));
+    }
+
+    static void PutBytes(std::vector<char> &buffer, const void *data, size_t size) {
+        const char *bytes = static_cast<const char *> (data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    static void Pad8(std::vector<char> &buffer) {
+        buffer.resize((buffer.size() + 7) / 8 * 8, 0);
+    }
+
+    //A value stored as F64: a complete number
+    static bool IsNumber(const std::string &value, double &number) {
+        if (value.empty()) {
+            return false;
+        }
+        char *end = 0;
+        number = std::strtod(value.c_str(), &end);
+        return *end == '\0';
+    }
+
+private:
+    struct Pending {
+        std::vector<std::string> names;
+        std::vector<std::vector<std::string> > rows;
+    };
+
+    static bool HasFields(const Pending &pending, const ResultRecord::FieldList &fields) {
+        if (pending.names.size() != fields.size()) {
+            return false;
+        }
+        for (uint32_t i = 0; i < fields.size(); i++) {
+            if (pending.names[i] != fields[i].first) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void WriteBlock(const std::string &tag, Pending &pending) {
+        uint32_t rows = pending.rows.size();
+        uint32_t columns = pending.names.size();
+        std::vector<char> block;
+        PutBytes(block, "BLK1", 4);
+        Put32(block, rows);
+        Put32(block, columns);
+        Put32(block, tag.size());
+        Put64(block, 0); //Block size, set below
+        PutBytes(block, tag.data(), tag.size());
+
+        //Directory, the column offsets are set once the data is laid out
+        std::vector<uint32_t> types(columns, 0);
+        std::vector<size_t> offsetAt(columns);
+        for (uint32_t c = 0; c < columns; c++) {
+            double number;
+            for (uint32_t r = 0; r < rows && types[c] == 0; r++) {
+                if (!IsNumber(pending.rows[r][c], number)) {
+                    types[c] = 1;
+                }
+            }
+            Put32(block, pending.names[c].size());
+            PutBytes(block, pending.names[c].data(), pending.names[c].size());
+            Put32(block, types[c]);
+            offsetAt[c] = block.size();
+            Put64(block, 0);
+        }
+        Pad8(block);
+
+        for (uint32_t c = 0; c < columns; c++) {
+            uint64_t offset = block.size();
+            std::memcpy(&block[offsetAt[c]], &offset, sizeof (offset));
+            if (types[c] == 0) {
+                for (uint32_t r = 0; r < rows; r++) {
+                    double number = 0.0;
+                    IsNumber(pending.rows[r][c], number);
+                    PutBytes(block, &number, sizeof (number));
+                }
+                continue;
+            }
+            uint32_t length = 0;
+            Put32(block, 0);
+            for (uint32_t r = 0; r < rows; r++) {
+                length += pending.rows[r][c].size();
+                Put32(block, length);
+            }
+            for (uint32_t r = 0; r < rows; r++) {
+                PutBytes(block, pending.rows[r][c].data(), pending.rows[r][c].size());
+            }
+            Pad8(block);
+        }
+        uint64_t size = block.size();
+        std::memcpy(&block[16], &size, sizeof (size));
+
+        //One append per block: readers see whole blocks or a truncated tail
+        if (!WriteAll(block)) {
+            Fail("cannot append a block");
+        }
+        pending.rows.clear();
+    }
+
+    bool WriteAll(const std::vector<char> &buffer) {
+        const char *data = &buffer[0];
+        size_t left = buffer.size();
+        while (left > 0) {
+            ssize_t n = write(m_fd, data, left);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += n;
+            left -= n;
+        }
+        return true;
+    }
+
+    void Fail(const char *reason) {
+        std::cerr << "ResultTable: " << m_path << ": " << reason << std::endl;
+        close(m_fd);
+        m_fd = -1;
+    }
+
+    std::string m_path;
+    uint32_t m_rowsPerBlock;
+    int m_fd;
+    std::map<std::string, Pending> m_pending; //Rows not written yet, per tag
+};
+
+//Output stream of a scenario binary: everything is echoed (e.g. to std::cout)
+//and every RESULT/WINDOW/RUN line is also appended to the table, if one is given
+class ResultTableStream : public std::ostream {
+public:
+    ResultTableStream(const std::string &path, std::ostream &echo)
+    : std::ostream(0),
+      m_buffer(echo),
+      m_writer(0) {
+        if (!path.empty()) {
+            m_writer = new ResultTableWriter(path);
+            m_buffer.SetWriter(m_writer);
+        }
+        rdbuf(&m_buffer);
+    }
+
+    ~ResultTableStream() {
+        flush();
+        delete m_writer;
+    }
+
+    bool IsOpen() const {
+        return m_writer == 0 || m_writer->IsOpen();
+    }
+
+private:
+    class Buffer : public std::streambuf {
+    public:
+        Buffer(std::ostream &echo)
+        : m_echo(echo),
+          m_writer(0) {
+        }
+
+        void SetWriter(ResultTableWriter *writer) {
+            m_writer = writer;
+        }
+
+    protected:
+        int overflow(int c) {
+            if (c != EOF) {
+                char ch = static_cast<char> (c);
+                xsputn(&ch, 1);
+            }
+            return c;
+        }
+
+        std::streamsize xsputn(const char *s, std::streamsize n) {
+            m_echo.write(s, n);
+            if (m_writer == 0) {
+                return n;
+            }
+            for (std::streamsize i = 0; i < n; i++) {
+                if (s[i] != '\n') {
+                    m_line += s[i];
+                    continue;
+                }
+                ResultRecord record;
+                if (ResultRecord::Parse(m_line, record) && !record.GetFields().empty()) {
+                    m_writer->Add(record);
+                }
+                m_line.clear();
+            }
+            return n;
+        }
+
+        int sync() {
+            m_echo.flush();
+            return 0;
+        }
+
+    private:
+        std::ostream &m_echo;
+        ResultTableWriter *m_writer;
+        std::string m_line; //Incomplete line
+    };
+
+    Buffer m_buffer;
+    ResultTableWriter *m_writer;
+};
+
+} // namespace ns3
+
+#endif /* RESULT_TABLE_H */
@@ -0,0 +1,197 @@
+/* Saturation traffic source
+   -------------------------
+
+   Keeps the Wi-Fi MAC queue of its node non-empty without overrunning it.
+   An OnOff source at 11 Mbps generates far more than the 802.11b channel with
+   RTS/CTS delivers, so most of its packets are built, pushed through UDP/IP
+   and dropped at the full MAC queue. SaturatedApplication instead looks at the
+   DcaTxop queue whenever the device starts a transmission (PHY "PhyTxBegin")
+   and, if fewer than LowWater packets are queued, sends packets until
+   HighWater are queued. The MAC always has a frame ready (saturation), but
+   only packets that will actually be transmitted are generated.
+
+   A slow guard timer (GuardInterval) tops the queue up as well, for the
+   phases without transmissions of the node (association, ARP resolution).
+
+   Packets are UDP datagrams of PacketSize bytes without any application
+   header, like OnOffApplication's, so a UdpServer counts them the same way.
+   With a PacketPool (SetPacketPool) the same pre-built packet is sent every
+   time instead of a new one (see packet-pool.h).
+*/
+
+#ifndef SATURATED_APPLICATION_H
+#define SATURATED_APPLICATION_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/wifi-module.h"
+
+#include "packet-pool.h"
+
+#include <string>
+
+namespace ns3 {
+
+class SaturatedApplication : public Application {
+public:
+    static TypeId GetTypeId(void) {
+        static TypeId tid = TypeId("ns3::SaturatedApplication")
+                .SetParent<Application> ()
+                .AddConstructor<SaturatedApplication> ()
+                .AddAttribute("Remote", "The address of the destination",
+                AddressValue(),
+                MakeAddressAccessor(&SaturatedApplication::m_peer),
+                MakeAddressChecker())
+                .AddAttribute("PacketSize", "UDP payload size in bytes",
+                UintegerValue(1024),
+                MakeUintegerAccessor(&SaturatedApplication::m_packetSize),
+                MakeUintegerChecker<uint32_t> (1))
+                .AddAttribute("LowWater", "Top the MAC queue up when it holds fewer packets than this",
+                UintegerValue(2),
+                MakeUintegerAccessor(&SaturatedApplication::m_lowWater),
+                MakeUintegerChecker<uint32_t> (1))
+                .AddAttribute("HighWater", "Number of packets the MAC queue is topped up to",
+                UintegerValue(4),
+                MakeUintegerAccessor(&SaturatedApplication::m_highWater),
+                MakeUintegerChecker<uint32_t> (1))
+                .AddAttribute("GuardInterval", "Period of the fallback queue check",
+                TimeValue(MilliSeconds(50)),
+                MakeTimeAccessor(&SaturatedApplication::m_guardInterval),
+                MakeTimeChecker())
+                .AddAttribute("MaxBytes", "Stop sending after this many payload bytes, 0: no limit (as OnOffApplication)",
+                UintegerValue(0),
+                MakeUintegerAccessor(&SaturatedApplication::m_maxBytes),
+                MakeUintegerChecker<uint64_t> ());
+        return tid;
+    }
+
+    SaturatedApplication()
+    : m_packetSize(1024),
+      m_lowWater(2),
+      m_highWater(4),
+      m_maxBytes(0),
+      m_sent(0),
+      m_running(false) {
+    }
+
+    //Send the pooled packet of the pool instead of allocating one per send
+    void SetPacketPool(Ptr<PacketPool> pool) {
+        m_pool = pool;
+    }
+
+    uint64_t GetSent(void) const {
+        return m_sent;
+    }
+
+protected:
+    virtual void DoDispose(void) {
+        m_socket = 0;
+        m_queue = 0;
+        m_phy = 0;
+        m_pool = 0;
+        Application::DoDispose();
+    }
+
+private:
+    virtual void StartApplication(void) {
+        Ptr<WifiNetDevice> device;
+        for (uint32_t i = 0; i < GetNode()->GetNDevices() && device == 0; i++) {
+            device = DynamicCast<WifiNetDevice> (GetNode()->GetDevice(i));
+        }
+        NS_ASSERT_MSG(device != 0, "SaturatedApplication needs a WifiNetDevice on its node");
+        PointerValue dca;
+        device->GetMac()->GetAttribute("DcaTxop", dca);
+        PointerValue queue;
+        dca.Get<DcaTxop> ()->GetAttribute("Queue", queue);
+        m_queue = queue.Get<WifiMacQueue> ();
+        m_phy = device->GetPhy();
+        m_phy->TraceConnectWithoutContext("PhyTxBegin", MakeCallback(&SaturatedApplication::TxBegin, this));
+
+        if (m_socket == 0) {
+            m_socket = Socket::CreateSocket(GetNode(), UdpSocketFactory::GetTypeId());
+            m_socket->Bind();
+            m_socket->Connect(m_peer);
+            m_socket->ShutdownRecv();
+        }
+        m_running = true;
+        Guard();
+    }
+
+    virtual void StopApplication(void) {
+        m_running = false;
+        Simulator::Cancel(m_guardEvent);
+        m_phy->TraceDisconnectWithoutContext("PhyTxBegin", MakeCallback(&SaturatedApplication::TxBegin, this));
+    }
+
+    void TxBegin(Ptr<const Packet> packet) {
+        TopUp();
+    }
+
+    void Guard(void) {
+        TopUp();
+        m_guardEvent = Simulator::Schedule(m_guardInterval, &SaturatedApplication::Guard, this);
+    }
+
+    //Each Send() reaches the MAC queue within this call (unless ARP holds it back),
+    //so the queue size is up to date after every packet
+    void TopUp(void) {
+        if (!m_running || m_queue->GetSize() >= m_lowWater) {
+            return;
+        }
+        uint32_t budget = m_highWater; //ARP or association may keep the queue from growing
+        while (m_queue->GetSize() < m_highWater && budget-- > 0
+                && (m_maxBytes == 0 || m_sent * m_packetSize < m_maxBytes)) {
+            m_socket->Send(m_pool != 0 ? m_pool->Get(m_packetSize) : Create<Packet> (m_packetSize));
+            m_sent++;
+        }
+    }
+
+    Address m_peer;
+    uint32_t m_packetSize;
+    uint32_t m_lowWater;
+    uint32_t m_highWater;
+    Time m_guardInterval;
+    uint64_t m_maxBytes;
+    Ptr<Socket> m_socket;
+    Ptr<WifiMacQueue> m_queue;
+    Ptr<WifiPhy> m_phy;
+    Ptr<PacketPool> m_pool; //0: a new packet per send
+    EventId m_guardEvent;
+    uint64_t m_sent;
+    bool m_running;
+};
+
+NS_OBJECT_ENSURE_REGISTERED(SaturatedApplication);
+
+//Client of one flow: "onoff" (OnOffApplication at dataRate, as originally) or
+//"saturated" (SaturatedApplication); dataRate is ignored by the latter. A pool
+//(one per simulation, shared by all flows) is only supported by "saturated"
+inline ApplicationContainer InstallTrafficSource(const std::string &traffic, Ptr<Node> node, Address remote,
+        uint32_t packetSize, const std::string &dataRate, Time start, Ptr<PacketPool> pool = 0) {
+    if (traffic == "onoff") {
+        if (pool != 0) {
+            NS_FATAL_ERROR("Packet pooling needs the saturated traffic source");
+        }
+        OnOffHelper onOffHelper("ns3::UdpSocketFactory", remote);
+        onOffHelper.SetAttribute("PacketSize", UintegerValue(packetSize));
+        onOffHelper.SetAttribute("DataRate", StringValue(dataRate));
+        onOffHelper.SetAttribute("StartTime", TimeValue(start));
+        return onOffHelper.Install(node);
+    }
+    if (traffic != "saturated") {
+        NS_FATAL_ERROR("Unknown traffic source " << traffic << " (onoff or saturated)");
+    }
+    Ptr<SaturatedApplication> application = CreateObject<SaturatedApplication> ();
+    application->SetAttribute("Remote", AddressValue(remote));
+    application->SetAttribute("PacketSize", UintegerValue(packetSize));
+    application->SetPacketPool(pool);
+    application->SetStartTime(start);
+    node->AddApplication(application);
+    return ApplicationContainer(application);
+}
+
+} // namespace ns3
+
+#endif /* SATURATED_APPLICATION_H */
@@ -0,0 +1,401 @@
+/* Single-cell scenario (Problem3)
+   -------------------------------
+
+                +-----+
+                | AP  |
+               /+-----+\
+              /    |    \
+             /     |     \
+            /      |      \
+           /       |       \
+   +-----+/     +-----+     \+-----+
+   |STA-1|      |STA-2| .... |STA-n|
+   +-----+      +-----+      +-----+
+
+   UDP data flow: STA-1->AP, STA-2->AP, ..., STA-n->AP
+
+   Shared by problem3a (collision probability), problem3b (throughput) and the
+   sweep driver. RunSingleCell() builds the network, runs the simulator to the
+   configured stop time and returns the measurements as a ResultRecord.
+
+   Large N (thousands of stations): addresses come from a 10.0.0.0 subnet once
+   192.168.1.0/24 is too small, --populateArp replaces ARP resolution by one
+   shared pre-filled cache and --startSpread staggers the client start times.
+   Every setup step is linear in N; setupTime/runTime (wall seconds) and
+   peakRssKb are reported with each run. Association cannot be pre-seeded
+   through the public StaWifiMac API, so stations still associate on the
+   first beacons; --startSpread keeps the data traffic out of that burst.
+*/
+
+#ifndef SINGLE_CELL_SCENARIO_H
+#define SINGLE_CELL_SCENARIO_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/flow-monitor-module.h"
+
+#include "convergence-stop.h"
+#include "light-pcap.h"
+#include "mac-counters.h"
+#include "mac-event-recorder.h"
+#include "measurement-window.h"
+#include "packet-pool.h"
+#include "profiling-scheduler.h"
+#include "replication.h"
+#include "resource-usage.h"
+#include "result-cache.h"
+#include "result-record.h"
+#include "saturated-application.h"
+#include "snapshot.h"
+#include "static-arp.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace ns3 {
+
+struct SingleCellConfig {
+    uint32_t nWifi; //No. of station nodes
+    double simTime; //Simulator stop time (seconds), upper bound with early stopping
+    uint32_t packetSize;
+    std::string dataRate; //OnOff data rate of every station
+    std::string traffic; //"onoff" or "saturated" (see saturated-application.h)
+    std::string phyMode; //Data and control WifiMode of every node (the model needs its timing)
+    bool packetPool; //Saturated stations resend one pooled packet (see packet-pool.h)
+    bool measureThroughput; //FlowMonitor based per-flow throughput (problem3b)
+    std::string pcapApPrefix; //Empty: no packet capture on the Access Point
+    std::string pcapStaPrefix; //Empty: no packet capture on the Stations
+    bool pcapPromiscuous;
+    CaptureOptions capture;
+    MacEventOptions macEvents; //Per-node MAC/PHY event rings, dumped on a trigger (see mac-event-recorder.h)
+    ConvergenceOptions convergence; //Early stop once collision probability and throughput have settled
+    std::string cacheDir; //Result cache (see result-cache.h), empty: always simulate
+    ProfilingOptions profiling; //Event scheduler and progress reports (see profiling-scheduler.h)
+    double startSpread; //Client i starts at 0.2 + startSpread * i / nWifi seconds (0: all at 0.2)
+    bool populateArp; //Pre-populated ARP caches instead of ARP exchanges (see static-arp.h)
+    WarmupOptions measurement; //Warm-up excluded from all counters (see measurement-window.h)
+    SnapshotOptions snapshot; //Variants branched off one warm-up (see snapshot.h), flows named by station index
+
+    SingleCellConfig()
+    : nWifi(1),
+      simTime(500.0),
+      packetSize(1024),
+      dataRate("11Mbps"),
+      traffic("onoff"),
+      phyMode("DsssRate11Mbps"),
+      packetPool(false),
+      measureThroughput(true),
+      pcapPromiscuous(false),
+      startSpread(0.0),
+      populateArp(false) {
+    }
+
+    void AddToCommandLine(CommandLine &cmd) {
+        cmd.AddValue("nWifi", "Number of Stations", nWifi);
+        cmd.AddValue("simTime", "Simulator stop time in seconds", simTime);
+        cmd.AddValue("packetSize", "UDP payload size in bytes", packetSize);
+        cmd.AddValue("dataRate", "OnOff data rate of every station", dataRate);
+        cmd.AddValue("traffic", "Station traffic source: onoff or saturated (keeps the MAC queue topped up)", traffic);
+        cmd.AddValue("phyMode", "Data and control WifiMode, e.g. DsssRate11Mbps or DsssRate2Mbps", phyMode);
+        cmd.AddValue("packetPool", "Send pooled packets instead of allocating one per send (saturated traffic)", packetPool);
+        cmd.AddValue("startSpread", "Spread the client start times over this many seconds (large N)", startSpread);
+        cmd.AddValue("populateArp", "Pre-populate the ARP caches instead of resolving addresses (large N)", populateArp);
+        capture.AddToCommandLine(cmd);
+        macEvents.AddToCommandLine(cmd);
+        convergence.AddToCommandLine(cmd);
+        measurement.AddToCommandLine(cmd);
+        snapshot.AddToCommandLine(cmd);
+        profiling.AddToCommandLine(cmd);
+        cmd.AddValue("cache", "Result cache directory; a hit skips the simulation and its captures (empty: off)", cacheDir);
+    }
+
+    ResultRecord ToRecord() const {
+        ResultRecord record;
+        record.Set("nWifi", nWifi);
+        record.Set("simTime", simTime);
+        record.Set("packetSize", packetSize);
+        record.Set("dataRate", dataRate);
+        record.Set("traffic", traffic);
+        record.Set("phyMode", phyMode);
+        record.Set("packetPool", packetPool ? 1 : 0);
+        record.Set("precision", convergence.precision);
+        record.Set("startSpread", startSpread);
+        record.Set("populateArp", populateArp ? 1 : 0);
+        record.Set("warmupMode", measurement.autoWarmup ? "auto" : (measurement.warmup > 0 ? "fixed" : "none"));
+        if (measurement.IsEnabled()) {
+            record.Set("warmupLimit", measurement.autoWarmup ? measurement.maxWarmup : measurement.warmup);
+        }
+        snapshot.AddToRecord(record);
+        return record;
+    }
+
+    //Result cache key of this configuration for one RNG run
+    std::string GetCacheKey(uint32_t rngRun) const {
+        ResultRecord key = ToRecord();
+        key.Set("measureThroughput", measureThroughput ? 1 : 0);
+        //Estimator settings change where a run stops or starts measuring
+        key.Set("batchTime", convergence.batchTime);
+        key.Set("minBatches", convergence.minBatches);
+        key.Set("autoInterval", measurement.autoInterval);
+        key.Set("autoSamples", measurement.autoSamples);
+        key.Set("autoTolerance", measurement.autoTolerance);
+        return ResultCache::MakeKey("single-cell", key, rngRun);
+    }
+};
+
+//Subnet holding the AP and nWifi stations: the original 192.168.1.0/24 as long as
+//it is large enough, the smallest 10.0.0.0 subnet beyond 253 stations
+inline void SetSingleCellAddressBase(Ipv4AddressHelper &helper, uint32_t nWifi) {
+    uint32_t hostBits = 8;
+    while ((1ULL << hostBits) < nWifi + 3ULL) { //AP + stations + network + broadcast
+        hostBits++;
+    }
+    if (hostBits == 8) {
+        helper.SetBase("192.168.1.0", "255.255.255.0");
+    } else {
+        NS_ASSERT_MSG(hostBits <= 24, "Too many stations for 10.0.0.0/8");
+        helper.SetBase(Ipv4Address("10.0.0.0"), Ipv4Mask(~((1U << hostBits) - 1)));
+    }
+}
+
+//Build the single-cell network, run it and return config + measurements
+inline ResultRecord SimulateSingleCell(const SingleCellConfig &config) {
+    WallClock setupClock; //Setup: everything up to Simulator::Run
+    config.profiling.Install();
+
+    //RTS/CTS activation
+    UintegerValue ctsThreshold = 0;
+    Config::SetDefault("ns3::WifiRemoteStationManager::RtsCtsThreshold", ctsThreshold);
+
+    //Create Access Point and Nodes
+    NodeContainer wifiApNode;
+    wifiApNode.Create(1); //Access Point
+    NodeContainer wifiStaNodes;
+    wifiStaNodes.Create(config.nWifi); //Nodes
+
+    //Create Wifi Channel and Phy
+    YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
+    YansWifiPhyHelper phy = YansWifiPhyHelper::Default();
+    phy.SetChannel(channel.Create());
+
+    //Create WifiHelper and MACHelper
+    WifiHelper wifiHelper = WifiHelper::Default();
+    wifiHelper.SetStandard(WIFI_PHY_STANDARD_80211b); //Setting WiFi Standard to 802.11b
+    wifiHelper.SetRemoteStationManager("ns3::ConstantRateWifiManager",
+            "DataMode", StringValue(config.phyMode),
+            "ControlMode", StringValue(config.phyMode)); //Data and control rate both from phyMode (11Mbps by default)
+    NqosWifiMacHelper wifiMacHelper = NqosWifiMacHelper::Default();
+
+    //Create SSID
+    Ssid ssid = Ssid("ssid_3a");
+
+    //Create NetDevices for Access Point and Nodes
+    NetDeviceContainer apDevices;
+    wifiMacHelper.SetType("ns3::ApWifiMac", "Ssid", SsidValue(ssid));
+    apDevices = wifiHelper.Install(phy, wifiMacHelper, wifiApNode);
+    NetDeviceContainer staDevices;
+    wifiMacHelper.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid), "ActiveProbing", BooleanValue(false));
+    staDevices = wifiHelper.Install(phy, wifiMacHelper, wifiStaNodes);
+    Snapshot snapshot(config.snapshot);
+    snapshot.AddDevices(apDevices);
+    snapshot.AddDevices(staDevices);
+
+    //Create MobilityHelper
+    MobilityHelper mobility;
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel"); //Positions of AP and Nodes are fixed
+    mobility.Install(wifiApNode); //Add Access Point to this Mobility Model
+    mobility.Install(wifiStaNodes); //Add all Nodes to this Mobility Model
+
+    //Setting up Internet stack in the Access Point and Nodes
+    InternetStackHelper stack;
+    stack.Install(wifiApNode);
+    stack.Install(wifiStaNodes);
+
+    //Create IPv4 Address Helper
+    Ipv4AddressHelper ipv4AddressHelper;
+
+    //Assign IP Addresses to Access Point and Nodes
+    SetSingleCellAddressBase(ipv4AddressHelper, config.nWifi);
+    Ipv4InterfaceContainer interfaceContainer_ap = ipv4AddressHelper.Assign(apDevices);
+    Ipv4InterfaceContainer interfaceContainer_sta = ipv4AddressHelper.Assign(staDevices);
+    if (config.populateArp) {
+        PopulateArpCache(NodeContainer(wifiApNode, wifiStaNodes));
+    }
+
+    //UDP flows: Individual Nodes -> Access Point
+    //Access Point: UDP Server, Individual Nodes: UDP Clients
+    UdpServerHelper udpServer(55555); //UDP Server listens on port 55555
+    ApplicationContainer udpAppl = udpServer.Install(wifiApNode.Get(0));
+    udpAppl.Start(Seconds(0.1)); //UDP Server starts at 0.1sec simulation time
+    udpAppl.Stop(Seconds(config.simTime));
+    ApplicationContainer application;
+    Ptr<PacketPool> packetPool; //One pool per simulation, shared by all stations
+    if (config.packetPool) {
+        packetPool = Create<PacketPool> ();
+    }
+    Address serverAddress = InetSocketAddress(interfaceContainer_ap.GetAddress(0), 55555); //UDP Client is bound to UDP Server
+    for (uint32_t counter = 0; counter < config.nWifi; counter++) {//Create UDP Client on each node
+        //UDP Clients start after UDP server has been started; staggered starts avoid a burst of simultaneous first transmissions
+        Time start = Seconds(0.2 + config.startSpread * counter / config.nWifi);
+        std::ostringstream flow;
+        flow << counter;
+        application.Add(snapshot.InstallTrafficSource(flow.str(), config.traffic, wifiStaNodes.Get(counter), serverAddress,
+                config.packetSize, config.dataRate, start, packetPool));
+    }
+    //In snapshot mode the window opens at the snapshot at the earliest
+    WarmupOptions measurement = config.snapshot.GetWarmup(config.measurement, 0.2 + config.startSpread);
+
+    //RTS and missed CTS counters
+    MacCounters macCounters;
+    macCounters.Install(apDevices);
+    macCounters.Install(staDevices);
+    MacEventRecorder macEvents(config.macEvents);
+    macEvents.Install(apDevices);
+    macEvents.Install(staDevices);
+
+    FlowMonitorHelper flowMonitor;
+    Ptr<FlowMonitor> monitor;
+    if (config.measureThroughput && !measurement.IsEnabled()) {//The window counts at the UDP server instead
+        monitor = flowMonitor.InstallAll();
+    }
+
+    //Packet capture settings (not with snapshots: every variant would write to the same files)
+    CaptureOptions capture = config.capture.Resolve(false);
+    LightPcapCapture lightPcap(capture);
+    if (capture.IsEnabled() && !snapshot.IsEnabled()) {
+        if (!config.pcapApPrefix.empty()) {
+            if (capture.IsLight()) {
+                lightPcap.Enable(config.pcapApPrefix, apDevices);
+            } else {
+                phy.EnablePcap(config.pcapApPrefix, apDevices, config.pcapPromiscuous);
+            }
+        }
+        if (!config.pcapStaPrefix.empty()) {
+            if (capture.IsLight()) {
+                lightPcap.Enable(config.pcapStaPrefix, staDevices);
+            } else {
+                phy.EnablePcap(config.pcapStaPrefix, staDevices, config.pcapPromiscuous);
+            }
+        }
+    }
+
+    //Early stopping on the collision probability and the total received rate
+    Ptr<UdpServer> server = DynamicCast<UdpServer> (udpAppl.Get(0));
+    ConvergenceStop convergence(config.convergence);
+    //Zero scales: collision probability 0.005, throughput 0.1 Mbps (a starved flow)
+    convergence.AddMetric("collisionProbability", new ConvergenceStop::CollisionMetric(macCounters), 0.005);
+    convergence.AddMetric("totalThroughput", new ConvergenceStop::ReceivedRateMetric(server,
+            config.packetSize, config.convergence.batchTime), 0.1);
+
+    //Steady-state window: counters and convergence batches start when it opens
+    MeasurementWindow window(measurement);
+    if (window.IsEnabled()) {
+        window.AddServer(server);
+        window.AddStartCallback(MakeCallback(&MacCounters::Reset, &macCounters));
+        window.AddStartCallback(MakeCallback(&ConvergenceStop::StartNow, &convergence));
+        window.Start(0.2 + config.startSpread);
+    } else {
+        convergence.Start(0.2 + config.startSpread + config.convergence.batchTime);
+    }
+
+    //Simulator settings
+    Simulator::Stop(Seconds(config.simTime));
+    double setupTime = setupClock.GetElapsed();
+    WallClock runClock;
+    if (snapshot.IsEnabled()) {
+        if (!snapshot.Branch()) {
+            //Parent: every variant has run to the end in its own child
+            ResultRecord record = snapshot.Merge(config.ToRecord(), 0);
+            record.Set("setupTime", setupTime);
+            Simulator::Destroy();
+            return record;
+        }
+        runClock.Restart();
+    }
+    Simulator::Run();
+    macEvents.Finish();
+
+    ResultRecord record = config.ToRecord();
+    record.Set("stopTime", Simulator::Now().GetSeconds());
+    record.Set("setupTime", setupTime);
+    record.Set("runTime", runClock.GetElapsed());
+    record.Set("peakRssKb", GetPeakRssKb());
+    if (window.IsEnabled()) {
+        window.AddSummary(record);
+    }
+    convergence.AddSummary(record);
+
+    //Collision probability: missed CTS / RTS transmitted
+    record.Set("rts", macCounters.GetTotalRts());
+    record.Set("missedCts", macCounters.GetTotalMissedCts());
+    record.Set("collisionProbability", macCounters.GetCollisionProbability());
+
+    //Total Throughput Calculation (Mbps = 2^20 bit/s, as in the Problem3b sheets)
+    //Averaged over the stations sending in this variant (all of them without a snapshot)
+    uint32_t stations = snapshot.IsEnabled() ? snapshot.GetNActive() : config.nWifi;
+    if (config.measureThroughput && window.IsEnabled()) {
+        //Inside the window: received packets at IP level (payload + UDP/IPv4 headers, as FlowMonitor rxBytes)
+        double length = Simulator::Now().GetSeconds() - window.GetStart();
+        double totalThroughput = window.IsOpen() && length > 0 ? window.GetReceived(0) * (config.packetSize + 28) * 8.0 / length / 1024 / 1024 : 0.0;
+        record.Set("totalThroughput", totalThroughput);
+        record.Set("averageThroughput", stations > 0 ? totalThroughput / stations : 0.0);
+    } else if (config.measureThroughput) {
+        double totalThroughput = 0.0;
+        monitor->CheckForLostPackets();
+        std::map<FlowId, FlowMonitor::FlowStats> flowStats = monitor->GetFlowStats();
+        for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator iterator = flowStats.begin(); iterator != flowStats.end(); ++iterator) {
+            if (iterator->second.rxPackets == 0) {
+                continue;
+            }
+            totalThroughput = totalThroughput + (iterator->second.rxBytes * 8.0 / (iterator->second.timeLastRxPacket.GetSeconds() - iterator->second.timeFirstTxPacket.GetSeconds()) / 1024 / 1024);
+        }
+        record.Set("totalThroughput", totalThroughput);
+        record.Set("averageThroughput", stations > 0 ? totalThroughput / stations : 0.0);
+    }
+
+    Simulator::Destroy();
+    if (snapshot.IsEnabled()) {
+        snapshot.Return(record);
+    }
+
+    return record;
+}
+
+//SimulateSingleCell, unless the result cache already holds the run
+inline ResultRecord RunSingleCell(const SingleCellConfig &config) {
+    ResultCache cache(config.cacheDir);
+    std::string key = cache.IsEnabled() ? config.GetCacheKey(RngSeedManager::GetRun()) : "";
+    ResultRecord record;
+    if (cache.Get(key, record)) {
+        return record;
+    }
+    record = SimulateSingleCell(config);
+    cache.Put(key, record);
+    if (cache.IsEnabled()) {
+        record.Set("cached", 0);
+    }
+    return record;
+}
+
+//RunSingleCell as one replication (see replication.h)
+class SingleCellReplication : public Replication::Scenario {
+public:
+    SingleCellReplication(const SingleCellConfig &config) : m_config(config) {
+    }
+
+    ResultRecord Run() {
+        return RunSingleCell(m_config);
+    }
+
+private:
+    SingleCellConfig m_config;
+};
+
+} // namespace ns3
+
+#endif /* SINGLE_CELL_SCENARIO_H */
@@ -0,0 +1,420 @@
+/* Snapshot after warm-up
+   ----------------------
+
+   Branches several variants of a scenario off one warmed-up simulation. The
+   network is built and simulated once up to --snapshot seconds; then one
+   forked child per variant continues from that shared state (copy-on-write),
+   applies its change and runs to the end. N variants cost one setup and one
+   warm-up plus N steady-state runs.
+
+   --variants lists the variants, separated by ';', each a name followed by
+   optional changes:
+
+     name[:change,change,...]
+
+     enable=<flow>[+<flow>...]   start flows held back with --idle
+     disable=<flow>[+<flow>...]  stop flows (OnOff/saturated MaxBytes = 1) and
+                                 flush the MAC queue of their source node
+     rate=<data rate>            new OnOff data rate of all flows
+     rts=<bytes>                 new RtsCtsThreshold of all devices
+     run=<n>                     RngSeedManager run n and fresh Wi-Fi streams
+
+   Flows are named as in the results of the scenario (A_a for the conflict
+   graph, the station index for the single cell). Example, the three Problem1
+   variants from one warm-up of B->b (see topologies/problem1.topo):
+
+     --snapshot=20 --idle=A_a,a_A --variants="1a;1b:enable=A_a;1c:enable=a_A"
+
+   The measurement window opens at the snapshot (or later, with a longer
+   --warmup), so every variant is measured from the branch point on. The
+   result is one record holding the fields of every variant, prefixed with
+   its name ("1b.throughput_A_a"); WINDOW records after the snapshot carry a
+   variant field. Flows that are idle or disabled in a variant (IsActive) are
+   left out of its throughput, fairness and starvation results. Packet
+   captures are off in snapshot mode, as all children would write to the
+   files opened by the parent.
+
+   The MAC queue of a disabled flow's node is flushed only when no other
+   active flow leaves that node; otherwise its backlog drains normally.
+
+   Reseeding only affects the Wi-Fi devices (PHY, station manager, DCF
+   backoff); other random variables keep the streams drawn at setup.
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/wifi-module.h"
+
+#include "list-spec.h"
+#include "measurement-window.h"
+#include "packet-pool.h"
+#include "resource-usage.h"
+#include "result-record.h"
+#include "saturated-application.h"
+#include "worker-pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+struct SnapshotVariant {
+    std::string name;
+    std::vector<std::string> enable; //Idle flows started at the snapshot
+    std::vector<std::string> disable; //Flows stopped at the snapshot
+    std::string dataRate; //Empty: unchanged
+    int64_t rtsThreshold; //-1: unchanged
+    uint32_t run; //0: unchanged
+
+    SnapshotVariant()
+    : rtsThreshold(-1),
+      run(0) {
+    }
+
+    //"name[:change,change,...]" as described above
+    static SnapshotVariant Parse(const std::string &text) {
+        SnapshotVariant variant;
+        std::string::size_type colon = text.find(':');
+        variant.name = text.substr(0, colon);
+        if (variant.name.empty() || variant.name.find_first_of(".= \t") != std::string::npos) {
+            NS_FATAL_ERROR("Snapshot variant \"" << text << "\": invalid name");
+        }
+        if (colon == std::string::npos) {
+            return variant;
+        }
+        std::istringstream changes(text.substr(colon + 1));
+        std::string change;
+        while (std::getline(changes, change, ',')) {
+            std::string::size_type eq = change.find('=');
+            std::string key = change.substr(0, eq);
+            std::string value = eq == std::string::npos ? "" : change.substr(eq + 1);
+            if (value.empty()) {
+                NS_FATAL_ERROR("Snapshot variant " << variant.name << ": cannot parse \"" << change << "\"");
+            }
+            if (key == "enable" || key == "disable") {
+                std::vector<std::string> &flows = key == "enable" ? variant.enable : variant.disable;
+                std::istringstream names(value);
+                std::string name;
+                while (std::getline(names, name, '+')) {
+                    flows.push_back(name);
+                }
+            } else if (key == "rate") {
+                variant.dataRate = value;
+            } else if (key == "rts") {
+                variant.rtsThreshold = std::strtol(value.c_str(), 0, 10);
+            } else if (key == "run") {
+                variant.run = std::strtoul(value.c_str(), 0, 10);
+            } else {
+                NS_FATAL_ERROR("Snapshot variant " << variant.name << ": unknown change " << key);
+            }
+        }
+        return variant;
+    }
+};
+
+struct SnapshotOptions {
+    double time; //Simulation time of the branch point, 0: no snapshot
+    std::string variants; //';' separated variant specifications
+    std::string idle; //Comma separated flows not started before the snapshot
+    uint32_t jobs; //Variants simulated concurrently, 0: one per core
+
+    SnapshotOptions()
+    : time(0.0),
+      jobs(0) {
+    }
+
+    void AddToCommandLine(CommandLine &cmd) {
+        cmd.AddValue("snapshot", "Warm up once for this many seconds, then branch the --variants (0: off)", time);
+        cmd.AddValue("variants", "Snapshot variants: name[:enable=f,disable=f,rate=r,rts=n,run=n];...", variants);
+        cmd.AddValue("idle", "Comma separated flows that only start in variants enabling them", idle);
+        cmd.AddValue("variantJobs", "Number of variants simulated concurrently (0: number of cores)", jobs);
+    }
+
+    bool IsEnabled() const {
+        return time > 0;
+    }
+
+    std::vector<SnapshotVariant> GetVariants() const {
+        std::vector<SnapshotVariant> result;
+        std::istringstream specs(variants);
+        std::string spec;
+        while (std::getline(specs, spec, ';')) {
+            if (!spec.empty()) {
+                result.push_back(SnapshotVariant::Parse(spec));
+            }
+        }
+        if (result.empty()) {
+            NS_FATAL_ERROR("--snapshot needs at least one variant (--variants)");
+        }
+        return result;
+    }
+
+    bool IsIdle(const std::string &flow) const {
+        std::vector<std::string> flows = SplitList(idle);
+        for (uint32_t i = 0; i < flows.size(); i++) {
+            if (flows[i] == flow) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //The warm-up of a scenario whose clients start at clientStart: in snapshot
+    //mode the measurement window opens at the snapshot at the earliest
+    WarmupOptions GetWarmup(const WarmupOptions &measurement, double clientStart) const {
+        WarmupOptions warmup = measurement;
+        if (IsEnabled()) {
+            if (measurement.autoWarmup) {
+                NS_FATAL_ERROR("--autoWarmup cannot be combined with --snapshot, use --warmup");
+            }
+            if (time <= clientStart) {
+                NS_FATAL_ERROR("--snapshot must be later than the client start (" << clientStart << " s)");
+            }
+            warmup.warmup = std::max(measurement.warmup, time - clientStart);
+        }
+        return warmup;
+    }
+
+    void AddToRecord(ResultRecord &record) const {
+        if (IsEnabled()) {
+            record.Set("snapshot", time);
+            record.Set("variants", variants);
+            record.Set("idle", idle.empty() ? "-" : idle);
+        }
+    }
+};
+
+class Snapshot : public WorkerPool::Job {
+public:
+    Snapshot(const SnapshotOptions &options)
+    : m_options(options),
+      m_warmupTime(0.0) {
+        if (m_options.IsEnabled()) {
+            m_variants = m_options.GetVariants();
+            m_results.resize(m_variants.size());
+            m_windows.resize(m_variants.size());
+        }
+    }
+
+    bool IsEnabled() const {
+        return m_options.IsEnabled();
+    }
+
+    //Traffic source of one flow (see InstallTrafficSource); an idle flow is only
+    //installed by a variant enabling it
+    ApplicationContainer InstallTrafficSource(const std::string &flow, const std::string &traffic, Ptr<Node> node,
+            Address remote, uint32_t packetSize, const std::string &dataRate, Time start, Ptr<PacketPool> pool) {
+        Flow entry;
+        entry.traffic = traffic;
+        entry.node = node;
+        entry.remote = remote;
+        entry.packetSize = packetSize;
+        entry.dataRate = dataRate;
+        entry.pool = pool;
+        if (!IsEnabled() || !m_options.IsIdle(flow)) {
+            entry.application = ns3::InstallTrafficSource(traffic, node, remote, packetSize, dataRate, start, pool);
+        }
+        m_flows[flow] = entry;
+        return entry.application;
+    }
+
+    //Whether a flow sends in this process: installed (not idle) and not disabled by the variant
+    bool IsActive(const std::string &flow) const {
+        if (!IsEnabled()) {
+            return true;
+        }
+        std::map<std::string, Flow>::const_iterator it = m_flows.find(flow);
+        return it != m_flows.end() && it->second.application.GetN() > 0 && m_disabled.count(flow) == 0;
+    }
+
+    uint32_t GetNActive() const {
+        uint32_t active = 0;
+        for (std::map<std::string, Flow>::const_iterator it = m_flows.begin(); it != m_flows.end(); ++it) {
+            active += IsActive(it->first) ? 1 : 0;
+        }
+        return active;
+    }
+
+    //Wi-Fi devices affected by rts and run changes
+    void AddDevices(NetDeviceContainer devices) {
+        m_devices.Add(devices);
+    }
+
+    //Simulates up to the snapshot time and forks one child per variant. Returns
+    //true in a child, with its variant applied; false in the parent once all
+    //variants have been collected (see Merge)
+    bool Branch() {
+        WallClock clock;
+        Simulator::Stop(Seconds(m_options.time) - Simulator::Now());
+        Simulator::Run();
+        m_warmupTime = clock.GetElapsed();
+        WorkerPool pool(m_options.jobs);
+        int32_t child = pool.Branch(*this, m_variants.size());
+        if (child < 0) {
+            return false;
+        }
+        Apply(m_variants[child]);
+        return true;
+    }
+
+    //Child: stream receiving the WINDOW records of the variant
+    std::ostream *GetWindowOutput() {
+        return &m_childWindows;
+    }
+
+    //Child: hand the result of the variant to the parent and exit
+    void Return(const ResultRecord &record) {
+        WorkerPool::Return(m_childWindows.str() + record.ToLine() + "\n");
+    }
+
+    std::string Execute(uint32_t index) {
+        return ""; //Unused, the children continue from Branch()
+    }
+
+    void Collect(uint32_t index, bool ok, const std::string &output) {
+        if (!ok) {
+            NS_FATAL_ERROR("Snapshot variant " << m_variants[index].name << " failed");
+        }
+        std::istringstream lines(output);
+        std::string line;
+        while (std::getline(lines, line)) {
+            ResultRecord parsed;
+            if (!ResultRecord::Parse(line, parsed)) {
+                continue;
+            }
+            if (parsed.GetTag() == "WINDOW") {
+                ResultRecord window("WINDOW");
+                window.Set("variant", m_variants[index].name);
+                window.Merge(parsed);
+                m_windows[index].push_back(window);
+            } else {
+                m_results[index] = parsed;
+            }
+        }
+    }
+
+    //Parent: base (the configuration) plus the fields of every variant that are
+    //not part of it, prefixed with the variant name; the variants' WINDOW
+    //records go to windows (if set)
+    ResultRecord Merge(const ResultRecord &base, std::ostream *windows) const {
+        ResultRecord record = base;
+        record.Set("warmupTime", m_warmupTime);
+        for (uint32_t v = 0; v < m_variants.size(); v++) {
+            const ResultRecord::FieldList &fields = m_results[v].GetFields();
+            for (ResultRecord::FieldList::const_iterator it = fields.begin(); it != fields.end(); ++it) {
+                if (!base.Has(it->first)) {
+                    record.Set(m_variants[v].name + "." + it->first, it->second);
+                }
+            }
+            if (windows != 0) {
+                for (uint32_t w = 0; w < m_windows[v].size(); w++) {
+                    m_windows[v][w].Print(*windows);
+                }
+            }
+        }
+        return record;
+    }
+
+private:
+    struct Flow {
+        std::string traffic;
+        Ptr<Node> node;
+        Address remote;
+        uint32_t packetSize;
+        std::string dataRate;
+        Ptr<PacketPool> pool;
+        ApplicationContainer application; //Empty while idle
+    };
+
+    Flow &GetFlow(const std::string &name) {
+        std::map<std::string, Flow>::iterator it = m_flows.find(name);
+        if (it == m_flows.end()) {
+            NS_FATAL_ERROR("Snapshot: unknown flow " << name);
+        }
+        return it->second;
+    }
+
+    void Apply(const SnapshotVariant &variant) {
+        if (!variant.dataRate.empty()) {
+            for (std::map<std::string, Flow>::iterator it = m_flows.begin(); it != m_flows.end(); ++it) {
+                it->second.dataRate = variant.dataRate;
+                for (uint32_t i = 0; i < it->second.application.GetN(); i++) {
+                    it->second.application.Get(i)->SetAttributeFailSafe("DataRate", StringValue(variant.dataRate));
+                }
+            }
+        }
+        for (uint32_t i = 0; i < variant.disable.size(); i++) {
+            Flow &flow = GetFlow(variant.disable[i]);
+            for (uint32_t j = 0; j < flow.application.GetN(); j++) {
+                flow.application.Get(j)->SetAttribute("MaxBytes", UintegerValue(1));
+            }
+            m_disabled.insert(variant.disable[i]);
+        }
+        //Drop the backlog of the disabled flows, unless an active flow shares the queue
+        for (uint32_t i = 0; i < variant.disable.size(); i++) {
+            Ptr<Node> node = GetFlow(variant.disable[i]).node;
+            bool shared = false;
+            for (std::map<std::string, Flow>::const_iterator it = m_flows.begin(); it != m_flows.end(); ++it) {
+                shared = shared || (it->second.node == node && IsActive(it->first));
+            }
+            if (!shared) {
+                FlushQueues(node);
+            }
+        }
+        for (uint32_t i = 0; i < variant.enable.size(); i++) {
+            Flow &flow = GetFlow(variant.enable[i]);
+            if (flow.application.GetN() == 0) {
+                //Start delays count from the moment an application is added
+                flow.application = ns3::InstallTrafficSource(flow.traffic, flow.node, flow.remote, flow.packetSize,
+                        flow.dataRate, Seconds(0), flow.pool);
+            }
+        }
+        if (variant.rtsThreshold >= 0) {
+            for (uint32_t i = 0; i < m_devices.GetN(); i++) {
+                Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (m_devices.Get(i));
+                device->GetRemoteStationManager()->SetAttribute("RtsCtsThreshold", UintegerValue(variant.rtsThreshold));
+            }
+        }
+        if (variant.run > 0) {
+            //Streams take the run number when they are (re)assigned
+            RngSeedManager::SetRun(variant.run);
+            WifiHelper::Default().AssignStreams(m_devices, 0);
+        }
+    }
+
+    static void FlushQueues(Ptr<Node> node) {
+        for (uint32_t d = 0; d < node->GetNDevices(); d++) {
+            Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (node->GetDevice(d));
+            if (device == 0) {
+                continue;
+            }
+            PointerValue txop;
+            device->GetMac()->GetAttribute("DcaTxop", txop);
+            txop.Get<DcaTxop> ()->GetQueue()->Flush();
+        }
+    }
+
+    SnapshotOptions m_options;
+    std::vector<SnapshotVariant> m_variants;
+    std::map<std::string, Flow> m_flows;
+    std::set<std::string> m_disabled; //Flows disabled by the variant of this child
+    NetDeviceContainer m_devices;
+    double m_warmupTime; //Wall seconds of the shared part
+    std::ostringstream m_childWindows;
+    std::vector<ResultRecord> m_results;
+    std::vector<std::vector<ResultRecord> > m_windows;
+};
+
+} // namespace ns3
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,58 @@
+/* Pre-populated ARP cache
+   -----------------------
+
+   Fills one permanent ArpCache with the IPv4/MAC pair of every interface of
+   the given nodes and installs it on all of their IPv4 interfaces, so no ARP
+   request/reply exchange (and no broadcast storm at application start) takes
+   place. The shared cache keeps setup linear in the number of nodes; one
+   cache per interface holding every peer would be quadratic.
+
+   Call after the IPv4 addresses have been assigned.
+*/
+
+#ifndef STATIC_ARP_H
+#define STATIC_ARP_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+namespace ns3 {
+
+inline void PopulateArpCache(NodeContainer nodes) {
+    Ptr<ArpCache> arp = CreateObject<ArpCache> ();
+    arp->SetAliveTimeout(Seconds(3600 * 24 * 365));
+
+    for (NodeContainer::Iterator i = nodes.Begin(); i != nodes.End(); ++i) {
+        Ptr<Ipv4L3Protocol> ip = (*i)->GetObject<Ipv4L3Protocol> ();
+        NS_ASSERT_MSG(ip != 0, "PopulateArpCache needs the internet stack installed");
+        ObjectVectorValue interfaces;
+        ip->GetAttribute("InterfaceList", interfaces);
+        for (ObjectVectorValue::Iterator j = interfaces.Begin(); j != interfaces.End(); ++j) {
+            Ptr<Ipv4Interface> ipInterface = j->second->GetObject<Ipv4Interface> ();
+            Ptr<NetDevice> device = ipInterface->GetDevice();
+            for (uint32_t k = 0; k < ipInterface->GetNAddresses(); k++) {
+                Ipv4Address address = ipInterface->GetAddress(k).GetLocal();
+                if (address == Ipv4Address::GetLoopback()) {
+                    continue;
+                }
+                ArpCache::Entry *entry = arp->Add(address);
+                entry->MarkWaitReply(0);
+                entry->MarkAlive(device->GetAddress());
+            }
+        }
+    }
+
+    for (NodeContainer::Iterator i = nodes.Begin(); i != nodes.End(); ++i) {
+        Ptr<Ipv4L3Protocol> ip = (*i)->GetObject<Ipv4L3Protocol> ();
+        ObjectVectorValue interfaces;
+        ip->GetAttribute("InterfaceList", interfaces);
+        for (ObjectVectorValue::Iterator j = interfaces.Begin(); j != interfaces.End(); ++j) {
+            j->second->GetObject<Ipv4Interface> ()->SetAttribute("ArpCache", PointerValue(arp));
+        }
+    }
+}
+
+} // namespace ns3
+
+#endif /* STATIC_ARP_H */
@@ -0,0 +1,248 @@
+/* Process worker pool
+   -------------------
+
+   ns-3 keeps a single global simulator per process, so independent simulation
+   runs are executed in forked child processes. Each task runs Job::Execute()
+   in a child, whose returned text travels back to the parent over a pipe and
+   is handed to Job::Collect() as soon as that child exits. At most "jobs"
+   children are alive at any time.
+
+   Fork before the parent touches the simulator (or on purpose after it, when
+   the children are meant to share the parent's simulation state).
+
+   Branch() forks the same way, but a child does not run Job::Execute(): it
+   returns from Branch() with its task index and continues from the state of
+   the parent (e.g. a warmed-up simulation), ending with Return(output).
+*/
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <cerrno>
+#include <stdint.h>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+class WorkerPool {
+public:
+    class Job {
+    public:
+        virtual ~Job() {
+        }
+        //Runs in the child process; the returned text is sent to the parent
+        virtual std::string Execute(uint32_t index) = 0;
+        //Runs in the parent; ok is false if the child crashed or failed
+        virtual void Collect(uint32_t index, bool ok, const std::string &output) = 0;
+    };
+
+    //jobs == 0: one worker per online core
+    WorkerPool(uint32_t jobs = 0) : m_jobs(jobs == 0 ? GetDefaultJobs() : jobs) {
+    }
+
+    static uint32_t GetDefaultJobs() {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        return cores > 0 ? static_cast<uint32_t> (cores) : 1;
+    }
+
+    uint32_t GetJobs() const {
+        return m_jobs;
+    }
+
+    //Run tasks 0..count-1; returns the number of failed tasks
+    uint32_t Run(Job &job, uint32_t count) {
+        std::vector<uint32_t> indices;
+        for (uint32_t i = 0; i < count; i++) {
+            indices.push_back(i);
+        }
+        return Run(job, indices);
+    }
+
+    uint32_t Run(Job &job, const std::vector<uint32_t> &indices) {
+        int32_t child = -1;
+        return Loop(job, indices, false, child);
+    }
+
+    //Tasks 0..count-1 as children continuing from the caller's state: returns
+    //the task index in a child, which must end with Return(); returns -1 in
+    //the parent once every child has been collected (Job::Execute is unused)
+    int32_t Branch(Job &job, uint32_t count) {
+        std::vector<uint32_t> indices;
+        for (uint32_t i = 0; i < count; i++) {
+            indices.push_back(i);
+        }
+        int32_t child = -1;
+        Loop(job, indices, true, child);
+        return child;
+    }
+
+    //End a Branch() child: send output to the parent and exit
+    static void Return(const std::string &output) {
+        bool ok = WriteAll(GetBranchFd(), output);
+        close(GetBranchFd());
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(NULL);
+        _exit(ok ? 0 : 1);
+    }
+
+private:
+    struct Worker {
+        pid_t pid;
+        int fd;
+        uint32_t index;
+        std::string output;
+    };
+
+    //Run (branch false) or Branch; child is set to the task index in a Branch child
+    uint32_t Loop(Job &job, const std::vector<uint32_t> &indices, bool branch, int32_t &child) {
+        std::vector<Worker> running;
+        uint32_t next = 0;
+        uint32_t failed = 0;
+
+        while (next < indices.size() || !running.empty()) {
+            while (next < indices.size() && running.size() < m_jobs) {
+                Worker worker;
+                bool isChild = false;
+                if (!Spawn(job, indices[next], running, worker, branch, isChild)) {
+                    job.Collect(indices[next], false, "");
+                    failed++;
+                } else if (isChild) {
+                    child = indices[next];
+                    return 0;
+                } else {
+                    running.push_back(worker);
+                }
+                next++;
+            }
+            if (running.empty()) {
+                continue;
+            }
+
+            std::vector<struct pollfd> fds(running.size());
+            for (uint32_t i = 0; i < running.size(); i++) {
+                fds[i].fd = running[i].fd;
+                fds[i].events = POLLIN;
+                fds[i].revents = 0;
+            }
+            if (poll(&fds[0], fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                std::perror("WorkerPool: poll");
+                break;
+            }
+
+            //Walk backwards so finished workers can be erased in place
+            for (uint32_t i = running.size(); i-- > 0;) {
+                if (fds[i].revents == 0) {
+                    continue;
+                }
+                char buffer[65536];
+                ssize_t n = read(running[i].fd, buffer, sizeof (buffer));
+                if (n > 0) {
+                    running[i].output.append(buffer, n);
+                    continue;
+                }
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                close(running[i].fd);
+                int status = 0;
+                while (waitpid(running[i].pid, &status, 0) < 0 && errno == EINTR) {
+                }
+                bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+                if (!ok) {
+                    failed++;
+                }
+                Worker done = running[i];
+                running.erase(running.begin() + i);
+                job.Collect(done.index, ok, done.output);
+            }
+        }
+        return failed;
+    }
+
+    //Write end of the pipe of a Branch child
+    static int &GetBranchFd() {
+        static int fd = -1;
+        return fd;
+    }
+
+    static bool WriteAll(int fd, const std::string &output) {
+        const char *data = output.data();
+        std::string::size_type left = output.size();
+        while (left > 0) {
+            ssize_t n = write(fd, data, left);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data += n;
+            left -= n;
+        }
+        return true;
+    }
+
+    static bool Spawn(Job &job, uint32_t index, const std::vector<Worker> &running, Worker &worker,
+            bool branch, bool &isChild) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            std::perror("WorkerPool: pipe");
+            return false;
+        }
+        //Unflushed stdio buffers would otherwise be written twice
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(NULL);
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::perror("WorkerPool: fork");
+            close(fds[0]);
+            close(fds[1]);
+            return false;
+        }
+        if (pid == 0) {
+            close(fds[0]);
+            for (uint32_t i = 0; i < running.size(); i++) {
+                close(running[i].fd);
+            }
+            if (branch) {
+                GetBranchFd() = fds[1];
+                isChild = true;
+                return true;
+            }
+            if (!WriteAll(fds[1], job.Execute(index))) {
+                _exit(1);
+            }
+            close(fds[1]);
+            std::cout.flush();
+            std::cerr.flush();
+            std::fflush(NULL);
+            //Skip the parent's atexit handlers and static destructors
+            _exit(0);
+        }
+        close(fds[1]);
+        worker.pid = pid;
+        worker.fd = fds[0];
+        worker.index = index;
+        return true;
+    }
+
+    uint32_t m_jobs;
+};
+
+} // namespace ns3
+
+#endif /* WORKER_POOL_H */
@@ -32,14 +32,11 @@
  */
 
 #include "ns3/core-module.h"
-#include "ns3/network-module.h"
-#include "ns3/applications-module.h"
-#include "ns3/wifi-module.h"
-#include "ns3/mobility-module.h"
-#include "ns3/ipv4-global-routing-helper.h" 
-#include "ns3/internet-module.h"
-#include "ns3/propagation-module.h"
-#include "ns3/flow-monitor-module.h"
+
+#include <iostream>
+
+#include "../Common/result-table.h"
+#include "../Common/single-cell-scenario.h"
 
 using namespace ns3;
 
@@ -47,100 +44,41 @@ NS_LOG_COMPONENT_DEFINE ("Problem3b");
 
 int main(int argc, char *argv[]) {
 
-    //No. of station nodes (simulation performed for the values 1-10)
-    uint32_t nWifi = 10;
-    uint32_t counter = 0; //Used to count station nodes later in the program
-    
-    //RTS/CTS activation
-    UintegerValue ctsThreshold = 0;
-    Config::SetDefault("ns3::WifiRemoteStationManager::RtsCtsThreshold", ctsThreshold);
-
-    //Create Access Point and Nodes
-    NodeContainer wifiApNode;
-    wifiApNode.Create(1); //Access Point
-    NodeContainer wifiStaNodes;
-    wifiStaNodes.Create(nWifi); //Nodes
-
-    //Create Wifi Channel and Phy
-    YansWifiChannelHelper channel = YansWifiChannelHelper::Default();
-    YansWifiPhyHelper phy = YansWifiPhyHelper::Default();
-    phy.SetChannel(channel.Create());
-
-    //Create WifiHelper and MACHelper
-    WifiHelper wifiHelper = WifiHelper::Default();
-    wifiHelper.SetStandard(WIFI_PHY_STANDARD_80211b); //Setting WiFi Standard to 802.11b
-    wifiHelper.SetRemoteStationManager("ns3::ConstantRateWifiManager",
-            "DataMode", StringValue("DsssRate11Mbps"),
-            "ControlMode", StringValue("DsssRate11Mbps")); //Setting Data rate and Control rate both to 11Mbps
-    NqosWifiMacHelper wifiMacHelper = NqosWifiMacHelper::Default();
-
-    //Create SSID
-    Ssid ssid = Ssid("ssid_3a");
-
-    //Create NetDevices for Access Point and Nodes
-    NetDeviceContainer apDevices;
-    wifiMacHelper.SetType("ns3::ApWifiMac", "Ssid", SsidValue(ssid));
-    apDevices = wifiHelper.Install(phy, wifiMacHelper, wifiApNode);
-    NetDeviceContainer staDevices;
-    wifiMacHelper.SetType("ns3::StaWifiMac", "Ssid", SsidValue(ssid), "ActiveProbing", BooleanValue(false));
-    staDevices = wifiHelper.Install(phy, wifiMacHelper, wifiStaNodes);
-
-    //Create MobilityHelper
-    MobilityHelper mobility;
-    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel"); //Positions of AP and Nodes are fixed
-    mobility.Install(wifiApNode); //Add Access Point to this Mobility Model
-    mobility.Install(wifiStaNodes); //Add all Nodes to this Mobility Model
-
-
-    //Setting up Internet stack in the Access Point and Nodes
-    InternetStackHelper stack;
-    stack.Install(wifiApNode);
-    stack.Install(wifiStaNodes);
-
-    //Create IPv4 Address Helper
-    Ipv4AddressHelper ipv4AddressHelper;
-
-    //Assign IP Addresses to Access Point and Nodes
-    ipv4AddressHelper.SetBase("192.168.1.0", "255.255.255.0");
-    Ipv4InterfaceContainer interfaceContainer_ap = ipv4AddressHelper.Assign(apDevices);
-    Ipv4InterfaceContainer interfaceContainer_sta = ipv4AddressHelper.Assign(staDevices);
-
-    //UDP flows: Individual Nodes -> Access Point
-    //Access Point: UDP Server, Individual Nodes: UDP Clients
-    UdpServerHelper udpServer(55555); //UDP Server listens on port 55555
-    ApplicationContainer udpAppl = udpServer.Install(wifiApNode.Get(0));
-    udpAppl.Start(Seconds(0.1)); //UDP Server starts at 0.1sec simulation time
-    udpAppl.Stop(Seconds(500.0));
-    ApplicationContainer application;
-    OnOffHelper onOffHelper("ns3::UdpSocketFactory", InetSocketAddress(interfaceContainer_ap.GetAddress(0), 55555)); //UDP Client is bound to UDP Server
-    onOffHelper.SetAttribute("PacketSize", UintegerValue(1024));
-    onOffHelper.SetAttribute("DataRate", StringValue("11Mbps"));
-    onOffHelper.SetAttribute("StartTime", TimeValue(Seconds(0.2))); //UDP Clients start after UDP server has been started
-    for (counter = 0; counter < nWifi; counter++) {//Create UDP Client on each node
-        application.Add(onOffHelper.Install(wifiStaNodes.Get(counter)));
-    }
+    SingleCellConfig config;
+    config.nWifi = 10; //No. of station nodes (simulation performed for the values 1-10)
+    config.simTime = 500.0;
+    config.measureThroughput = true;
 
-    FlowMonitorHelper flowMonitor;
-    Ptr<FlowMonitor> monitor = flowMonitor.InstallAll();
+    ReplicationOptions replication;
+    std::string table; //Empty: text output only
 
-    //Packet capture settings
-    phy.EnablePcapAll("problem3b");
-
-    //Simulator settings
-    Simulator::Stop(Seconds(500.0));
-    Simulator::Run();
-    
-    //Total Throughput Calculation
-    double totalThroughput = 0.0;
-    monitor->CheckForLostPackets();
-    std::map<FlowId, FlowMonitor::FlowStats> flowStats = monitor->GetFlowStats();
-    for (std::map<FlowId, FlowMonitor::FlowStats>::const_iterator iterator = flowStats.begin(); iterator != flowStats.end(); ++iterator) {
-        totalThroughput = totalThroughput + (iterator->second.rxBytes * 8.0 / (iterator->second.timeLastRxPacket.GetSeconds() - iterator->second.timeFirstTxPacket.GetSeconds()) / 1024 / 1024);
+    CommandLine cmd;
+    config.AddToCommandLine(cmd);
+    replication.AddToCommandLine(cmd);
+    cmd.AddValue("table", "Also append the result records to this binary table (see Common/result-table.h)", table);
+    cmd.Parse(argc, argv);
+
+    ResultTableStream out(table, std::cout);
+    if (!out.IsOpen()) {
+        NS_FATAL_ERROR("Cannot open result table " << table);
     }
 
-    std::cout << "No of Sources: " << nWifi << "\tTotal Throughput(in Mbps): " << totalThroughput << "\tAverage Throughput(in Mbps): " << (totalThroughput / nWifi) << "\n";
+    //Packet capture settings
+    config.pcapApPrefix = "problem3b";
+    config.pcapStaPrefix = "problem3b";
+
+    ResultRecord record;
+    if (replication.IsEnabled()) {
+        //Independent replications in worker processes; the throughputs below are their means
+        config.capture.mode = "none";
+        SingleCellReplication scenario(config);
+        record = Replication(replication, &out).Run(scenario, config.ToRecord());
+    } else {
+        record = RunSingleCell(config);
+    }
 
-    Simulator::Destroy();
+    std::cout << "No of Sources: " << config.nWifi << "\tTotal Throughput(in Mbps): " << record.GetDouble("totalThroughput") << "\tAverage Throughput(in Mbps): " << record.GetDouble("averageThroughput") << "\n";
+    record.Print(out);
 
     return 0;
 }
@@ -0,0 +1,190 @@
+/* Random conflict-graph batch
+   ---------------------------
+
+   Samples --graphs random link-conflict graphs (see Common/random-topology.h)
+   and simulates each one in its own forked process, up to --jobs at a time.
+   Runs are short: they stop as soon as every flow throughput has settled to
+   --precision, --simTime is only the upper bound. Every finished graph is
+   appended to one CSV row with its interaction pattern, the throughput of
+   each link and its starvation class:
+
+     dead      every link below --deadFloor Mbps (nothing gets through)
+     fair      no link below starvationShare of the fair share
+     starved   some links starved, listed in "starved" (1-based, '+' separated)
+
+     ./waf --run "scratch/randomGraphs --graphs=5000 --links=6 --density=0.4 --asymmetry=0.8 --output=random6.csv"
+
+   Graph i of a --seed is the same in every batch, --firstGraph continues a
+   batch (rows are appended to an existing --output); a single row is
+   reproduced with --firstGraph=i --graphs=1. RngRun only changes the
+   simulation, not the graphs.
+*/
+
+#include "ns3/core-module.h"
+
+#include "../Common/conflict-graph-scenario.h"
+#include "../Common/flow-metrics.h"
+#include "../Common/random-topology.h"
+#include "../Common/result-record.h"
+#include "../Common/result-table.h"
+#include "../Common/worker-pool.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("RandomGraphs");
+
+class RandomGraphJob : public WorkerPool::Job {
+public:
+    RandomGraphJob(const RandomTopologyOptions &options, uint32_t firstGraph, double deadFloor, const ConflictGraphConfig &config,
+            const std::string &output, std::ostream &out)
+    : m_options(options),
+      m_firstGraph(firstGraph),
+      m_deadFloor(deadFloor),
+      m_config(config),
+      m_headerWritten(false),
+      m_out(out) {
+        //A continued batch appends below the header of the first one
+        std::ifstream existing(output.c_str());
+        m_headerWritten = firstGraph > 0 && existing && existing.peek() != std::ifstream::traits_type::eof();
+        m_output.open(output.c_str(), m_headerWritten ? std::ios::app : std::ios::trunc);
+    }
+
+    std::string Execute(uint32_t index) {
+        RandomTopology graph(m_options, m_firstGraph + index);
+        return RunConflictGraph(graph.GetTopology(), m_config).ToLine() + "\n";
+    }
+
+    void Collect(uint32_t index, bool ok, const std::string &output) {
+        uint32_t graphIndex = m_firstGraph + index;
+        ResultRecord result;
+        if (!ok || !ResultRecord::Parse(output, result)) {
+            std::cerr << "RandomGraphs: graph " << graphIndex << " failed" << std::endl;
+            return;
+        }
+
+        //The parent samples the graph again instead of shipping it through the pipe
+        RandomTopology graph(m_options, graphIndex);
+        const ConflictGraphTopology &topology = graph.GetTopology();
+        ResultRecord record;
+        record.Set("graph", graphIndex);
+        record.Set("seed", m_options.seed);
+        record.Set("links", m_options.links);
+        record.Set("pairs", graph.GetInteractingPairs());
+        record.Set("asymmetricPairs", graph.GetAsymmetricPairs());
+        record.Set("interactions", graph.GetPairs());
+
+        std::vector<double> throughput;
+        for (uint32_t f = 0; f < topology.flows.size(); f++) {
+            throughput.push_back(result.GetDouble("throughput_" + ConflictGraphTopology::GetFlowName(topology.flows[f])));
+        }
+        //Relative starvation needs some traffic: below the floor on every link the graph is dead
+        bool dead = true;
+        for (uint32_t f = 0; f < throughput.size(); f++) {
+            dead = dead && throughput[f] < m_deadFloor;
+        }
+        std::vector<bool> isStarved = dead ? std::vector<bool> (throughput.size(), true)
+                : FlowMetrics::GetStarved(throughput, m_config.starvationShare);
+        std::ostringstream starved;
+        uint32_t nStarved = 0;
+        for (uint32_t f = 0; f < isStarved.size(); f++) {
+            if (isStarved[f]) {
+                starved << (nStarved == 0 ? "" : "+") << f + 1;
+                nStarved++;
+            }
+        }
+        record.Set("class", dead ? "dead" : (nStarved == 0 ? "fair" : "starved"));
+        record.Set("nStarved", nStarved);
+        record.Set("starved", nStarved == 0 ? "-" : starved.str());
+        record.Set("jain", result.Get("jain"));
+        record.Set("stopTime", result.Get("stopTime"));
+        record.Set("converged", result.Get("converged", "0"));
+
+        //Link columns last, so rows of different link counts share their leading columns
+        for (uint32_t f = 0; f < throughput.size(); f++) {
+            std::ostringstream name;
+            name << "throughput_" << f + 1;
+            record.Set(name.str(), throughput[f]);
+        }
+        Write(record);
+    }
+
+private:
+    void Write(const ResultRecord &record) {
+        const ResultRecord::FieldList &fields = record.GetFields();
+        if (!m_headerWritten) {
+            for (uint32_t i = 0; i < fields.size(); i++) {
+                m_output << (i == 0 ? "" : ",") << fields[i].first;
+            }
+            m_output << "\n";
+            m_headerWritten = true;
+        }
+        for (uint32_t i = 0; i < fields.size(); i++) {
+            m_output << (i == 0 ? "" : ",") << fields[i].second;
+        }
+        m_output << std::endl;
+        m_out << record.ToLine() << std::endl;
+    }
+
+    RandomTopologyOptions m_options;
+    uint32_t m_firstGraph;
+    double m_deadFloor; //Mbps
+    ConflictGraphConfig m_config;
+    std::ofstream m_output;
+    bool m_headerWritten;
+    std::ostream &m_out; //Echo of every row as a RESULT line
+};
+
+int main(int argc, char *argv[]) {
+
+    uint32_t graphs = 1000;
+    uint32_t firstGraph = 0;
+    double deadFloor = 0.01; //Mbps
+    uint32_t jobs = 0; //0: one worker per core
+    std::string output = "random-graphs.csv";
+    std::string table; //Empty: CSV and text output only
+    RandomTopologyOptions options;
+    ConflictGraphConfig config;
+    //Short runs: saturated flows, no windows, stop once settled
+    config.simTime = 60.0;
+    config.traffic = "saturated";
+    config.metricsInterval = 0.0;
+    config.convergence.precision = 0.02;
+
+    CommandLine cmd;
+    cmd.AddValue("graphs", "Number of random graphs", graphs);
+    cmd.AddValue("firstGraph", "Index of the first graph of the batch (> 0: append to --output)", firstGraph);
+    cmd.AddValue("deadFloor", "A graph with every link below this throughput (Mbps) is dead", deadFloor);
+    cmd.AddValue("jobs", "Number of graphs simulated concurrently (0: number of cores)", jobs);
+    cmd.AddValue("output", "CSV file receiving one row per graph", output);
+    cmd.AddValue("table", "Also append the result records to this binary table (see Common/result-table.h)", table);
+    options.AddToCommandLine(cmd);
+    config.AddToCommandLine(cmd);
+    cmd.Parse(argc, argv);
+
+    if (options.links == 0) {
+        NS_FATAL_ERROR("A random graph needs at least one link");
+    }
+    if (config.snapshot.IsEnabled()) {
+        NS_FATAL_ERROR("--snapshot branches one topology, it does not apply to a random batch");
+    }
+    //Packet captures of concurrent runs would overwrite each other
+    config.pcapPrefix = "";
+
+    ResultTableStream out(table, std::cout);
+    if (!out.IsOpen()) {
+        NS_FATAL_ERROR("Cannot open result table " << table);
+    }
+    RandomGraphJob job(options, firstGraph, deadFloor, config, output, out);
+    WorkerPool pool(jobs);
+    std::cerr << "RandomGraphs: " << graphs << " graphs of " << options.links << " links (density " << options.density
+            << ", asymmetry " << options.asymmetry << ") on " << pool.GetJobs() << " workers" << std::endl;
+    uint32_t failed = pool.Run(job, graphs);
+
+    return failed == 0 ? 0 : 1;
+}
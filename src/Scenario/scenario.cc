@@ -0,0 +1,142 @@
+/* Conflict-graph scenario runner
+   ------------------------------
+
+   Runs multi-cell topologies written in the conflict-graph format (see
+   Common/conflict-graph-topology.h and the examples in topologies/) without
+   compiling a binary per topology.
+
+     ./waf --run "scratch/scenario --topology=problem1b.topo"
+     ./waf --run "scratch/scenario --batch=variants.txt --jobs=32 --output=variants.res"
+
+   --batch names a file with one topology path per line. With more than one
+   topology every run gets its own forked simulator process (see
+   Common/worker-pool.h). Each run prints one RESULT line tagged with its
+   topology path, preceded by its per-flow WINDOW lines (see
+   Common/flow-metrics.h); --output additionally collects these lines in a file,
+   --table appends them to a binary result table (see Common/result-table.h).
+*/
+
+#include "ns3/core-module.h"
+
+#include "../Common/conflict-graph-scenario.h"
+#include "../Common/list-spec.h"
+#include "../Common/result-record.h"
+#include "../Common/result-table.h"
+#include "../Common/worker-pool.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Scenario");
+
+class ScenarioJob : public WorkerPool::Job {
+public:
+    ScenarioJob(const std::vector<std::string> &paths, const ConflictGraphConfig &config, const std::string &output, std::ostream &out)
+    : m_paths(paths),
+      m_config(config),
+      m_out(out) {
+        if (!output.empty()) {
+            m_output.open(output.c_str());
+        }
+    }
+
+    //WINDOW lines followed by the RESULT line
+    std::string Execute(uint32_t index) {
+        std::ostringstream windows;
+        ResultRecord record = RunConflictGraph(ConflictGraphTopology::LoadFile(m_paths[index]), m_config, &windows);
+        return windows.str() + record.ToLine() + "\n";
+    }
+
+    void Collect(uint32_t index, bool ok, const std::string &output) {
+        if (!ok) {
+            std::cerr << "Scenario: " << m_paths[index] << " failed" << std::endl;
+            return;
+        }
+        std::istringstream lines(output);
+        std::string line;
+        while (std::getline(lines, line)) {
+            ResultRecord parsed;
+            if (!ResultRecord::Parse(line, parsed)) {
+                continue;
+            }
+            //Tag every line with its topology
+            ResultRecord record(parsed.GetTag());
+            record.Set("topology", m_paths[index]);
+            record.Merge(parsed);
+            Write(record);
+        }
+    }
+
+    void Write(const ResultRecord &record) {
+        m_out << record.ToLine() << std::endl;
+        if (m_output.is_open()) {
+            m_output << record.ToLine() << std::endl;
+        }
+    }
+
+private:
+    std::vector<std::string> m_paths;
+    ConflictGraphConfig m_config;
+    std::ofstream m_output;
+    std::ostream &m_out;
+};
+
+int main(int argc, char *argv[]) {
+
+    std::string topologyList;
+    std::string batchFile;
+    uint32_t jobs = 0; //0: one worker per core
+    std::string output;
+    std::string table; //Empty: text output only
+    ConflictGraphConfig config;
+
+    CommandLine cmd;
+    cmd.AddValue("topology", "Comma separated list of topology files", topologyList);
+    cmd.AddValue("batch", "File listing one topology file per line", batchFile);
+    cmd.AddValue("jobs", "Number of topologies simulated concurrently (0: number of cores)", jobs);
+    cmd.AddValue("output", "File collecting the RESULT lines", output);
+    cmd.AddValue("table", "Also append the result records to this binary table (see Common/result-table.h)", table);
+    config.AddToCommandLine(cmd);
+    cmd.Parse(argc, argv);
+
+    std::vector<std::string> paths = SplitList(topologyList);
+    if (!batchFile.empty()) {
+        std::ifstream batch(batchFile.c_str());
+        if (!batch) {
+            NS_FATAL_ERROR("Cannot open batch file " << batchFile);
+        }
+        std::string line;
+        while (std::getline(batch, line)) {
+            if (!line.empty() && line[0] != '#') {
+                paths.push_back(line);
+            }
+        }
+    }
+    if (paths.empty()) {
+        NS_FATAL_ERROR("No topology given, use --topology or --batch");
+    }
+
+    ResultTableStream out(table, std::cout);
+    if (!out.IsOpen()) {
+        NS_FATAL_ERROR("Cannot open result table " << table);
+    }
+
+    if (paths.size() == 1) {
+        ScenarioJob job(paths, config, output, out);
+        job.Collect(0, true, job.Execute(0));
+        return 0;
+    }
+
+    //Packet captures of concurrent runs would overwrite each other
+    config.pcapPrefix = "";
+    ScenarioJob job(paths, config, output, out);
+    WorkerPool pool(jobs);
+    uint32_t failed = pool.Run(job, paths.size());
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,289 @@
+/* Parallel sweep driver
+   ---------------------
+
+   Runs the single-cell scenario (problem3a/problem3b) for every combination of
+   the given parameter lists. Each point is simulated in its own forked process
+   (one simulator instance per process), up to --jobs points at a time, and every
+   finished point is appended to one CSV file with the collision probability and
+   the total/average throughput. The CSV columns are the union of the fields of
+   all rows (a field missing from a row is an empty cell).
+
+   Example:
+     ./waf --run "scratch/sweep --nWifi=1-10 --simTime=500 --output=3a_3b.csv"
+
+   List syntax: comma separated values and inclusive ranges, e.g. "1-4,8,10".
+
+   With --precision (e.g. 0.02) points stop early once the collision probability
+   and the throughput have settled to it (see Common/convergence-stop.h); by
+   default (0) every point runs for the full --simTime.
+
+   With --replications=K every point is run K times with RngRun firstRun ..
+   firstRun+K-1 and its row holds the mean, _sd and _ci (95%) of every
+   measurement (see Common/replication.h).
+
+   Every run is stored in the result cache (--cache, see Common/result-cache.h)
+   under the hash of its configuration, attribute defaults, RNG run and binary;
+   a repeated sweep only simulates the points that are missing or invalidated.
+
+   Every row also carries the saturation prediction of Bianchi's model
+   (model_collisionProbability, model_totalThroughput, see
+   Common/bianchi-model.h) and the simulation - model gap (gap_*).
+   --engine=model skips the simulation, e.g. to screen a large space first:
+     ./waf --run "scratch/sweep --engine=model --nWifi=1-200 --packetSize=64-2304"
+
+   --table additionally appends every row to a binary result table (see
+   Common/result-table.h), read with the standalone Tools/resultTable.cc.
+*/
+
+#include "ns3/core-module.h"
+
+#include "../Common/bianchi-model.h"
+#include "../Common/list-spec.h"
+#include "../Common/replication.h"
+#include "../Common/result-cache.h"
+#include "../Common/result-record.h"
+#include "../Common/result-table.h"
+#include "../Common/single-cell-scenario.h"
+#include "../Common/worker-pool.h"
+
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Sweep");
+
+class SweepJob : public WorkerPool::Job {
+public:
+    //Task index = point * replications + replication
+    SweepJob(const std::vector<SingleCellConfig> &points, uint32_t replications, uint32_t firstRun, bool model, const std::string &output,
+            std::ostream &out)
+    : m_points(points),
+      m_replications(replications),
+      m_firstRun(firstRun),
+      m_model(model),
+      m_path(output),
+      m_out(out) {
+        for (uint32_t i = 0; replications > 1 && i < points.size(); i++) {
+            m_stats.push_back(ReplicationStats(points[i].ToRecord()));
+        }
+        m_done.resize(points.size(), 0);
+    }
+
+    std::string Execute(uint32_t index) {
+        RngSeedManager::SetRun(GetRun(index));
+        return RunSingleCell(m_points[index / m_replications]).ToLine() + "\n";
+    }
+
+    uint32_t GetRun(uint32_t index) const {
+        return m_firstRun + index % m_replications;
+    }
+
+    //Record of a task from the result cache, without forking a worker
+    bool GetCached(uint32_t index, std::string &output) const {
+        const SingleCellConfig &config = m_points[index / m_replications];
+        ResultRecord record;
+        if (!ResultCache(config.cacheDir).Get(config.GetCacheKey(GetRun(index)), record)) {
+            return false;
+        }
+        output = record.ToLine() + "\n";
+        return true;
+    }
+
+    void Collect(uint32_t index, bool ok, const std::string &output) {
+        uint32_t point = index / m_replications;
+        ResultRecord record;
+        bool parsed = ok && ResultRecord::Parse(output, record);
+        if (!parsed) {
+            std::cerr << "Sweep: point " << point << " (nWifi=" << m_points[point].nWifi << ") failed" << std::endl;
+        }
+        if (m_replications == 1) {
+            if (parsed) {
+                Write(record, point);
+            }
+            return;
+        }
+
+        //Merge replications as they arrive; a point is written once all of them are in
+        if (parsed) {
+            m_stats[point].Add(record);
+        } else {
+            m_stats[point].AddFailure();
+        }
+        if (++m_done[point] == m_replications) {
+            Write(m_stats[point].GetSummary(), point);
+            m_stats[point] = ReplicationStats();
+        }
+    }
+
+    //Row of a point with the analytical prediction only
+    void WriteModel(uint32_t point) {
+        Write(m_points[point].ToRecord(), point);
+    }
+
+private:
+    void Write(const ResultRecord &result, uint32_t point) {
+        ResultRecord record = result;
+        if (m_model) {
+            const SingleCellConfig &config = m_points[point];
+            BianchiModel(DcfTiming::FromPhyMode(config.phyMode)).AddPrediction(record, config.nWifi, config.packetSize, config.dataRate);
+        }
+        m_rows.push_back(record);
+
+        //Columns are the union of all fields; a new one rewrites the file with the wider header
+        const ResultRecord::FieldList &fields = record.GetFields();
+        bool grown = !m_output.is_open();
+        for (uint32_t i = 0; i < fields.size(); i++) {
+            if (m_isColumn.insert(fields[i].first).second) {
+                m_columns.push_back(fields[i].first);
+                grown = true;
+            }
+        }
+        if (grown) {
+            m_output.close();
+            m_output.open(m_path.c_str(), std::ios::trunc);
+            for (uint32_t i = 0; i < m_columns.size(); i++) {
+                m_output << (i == 0 ? "" : ",") << m_columns[i];
+            }
+            m_output << "\n";
+            for (uint32_t r = 0; r + 1 < m_rows.size(); r++) {
+                WriteRow(m_rows[r]);
+            }
+        }
+        WriteRow(record);
+        m_output.flush();
+        m_out << record.ToLine() << std::endl;
+    }
+
+    //Missing fields are empty cells
+    void WriteRow(const ResultRecord &record) {
+        for (uint32_t i = 0; i < m_columns.size(); i++) {
+            m_output << (i == 0 ? "" : ",") << record.Get(m_columns[i]);
+        }
+        m_output << "\n";
+    }
+
+    std::vector<SingleCellConfig> m_points;
+    uint32_t m_replications;
+    uint32_t m_firstRun;
+    bool m_model; //Add the Bianchi prediction and the simulation - model gap
+    std::vector<ReplicationStats> m_stats; //Per point, only with replications
+    std::vector<uint32_t> m_done; //Finished replications per point
+    std::string m_path;
+    std::ofstream m_output;
+    std::vector<std::string> m_columns; //CSV header
+    std::set<std::string> m_isColumn;
+    std::vector<ResultRecord> m_rows; //Written so far, for a rewrite with new columns
+    std::ostream &m_out; //Echo of every row as a RESULT line
+};
+
+int main(int argc, char *argv[]) {
+
+    std::string nWifiList = "1-10"; //No. of station nodes per point
+    std::string packetSizeList = "1024";
+    std::string dataRateList = "11Mbps";
+    std::string traffic = "onoff";
+    std::string phyMode = "DsssRate11Mbps"; //Data and control WifiMode of every point
+    bool packetPool = false;
+    double simTime = 500.0;
+    uint32_t jobs = 0; //0: one worker per core
+    std::string output = "sweep.csv";
+    std::string table; //Empty: CSV and text output only
+    uint32_t replications = 1; //Independent runs per point
+    uint32_t firstRun = 0; //0: current RngRun
+    std::string cacheDir = ".result-cache";
+    std::string engine = "both"; //sim, model or both
+    WarmupOptions measurement;
+    ProfilingOptions profiling;
+    ConvergenceOptions convergence;
+
+    CommandLine cmd;
+    cmd.AddValue("nWifi", "List of station counts, e.g. 1-10", nWifiList);
+    cmd.AddValue("packetSize", "List of UDP payload sizes in bytes", packetSizeList);
+    cmd.AddValue("dataRate", "List of OnOff data rates", dataRateList);
+    cmd.AddValue("traffic", "Station traffic source: onoff or saturated", traffic);
+    cmd.AddValue("phyMode", "Data and control WifiMode of every point (DSSS rates for the model)", phyMode);
+    cmd.AddValue("packetPool", "Saturated stations send pooled packets", packetPool);
+    cmd.AddValue("simTime", "Simulator stop time (upper bound) of every point in seconds", simTime);
+    cmd.AddValue("jobs", "Number of points simulated concurrently (0: number of cores)", jobs);
+    cmd.AddValue("output", "CSV file receiving one row per point", output);
+    cmd.AddValue("table", "Also append the result records to this binary table (see Common/result-table.h)", table);
+    cmd.AddValue("replications", "Independent replications per point (distinct RngRun values)", replications);
+    cmd.AddValue("firstRun", "RngRun of the first replication (0: current RngRun)", firstRun);
+    cmd.AddValue("cache", "Result cache directory, points found there are not simulated again (empty: off)", cacheDir);
+    cmd.AddValue("engine", "sim: simulate, model: Bianchi model only, both: simulation and model gap", engine);
+    convergence.AddToCommandLine(cmd);
+    measurement.AddToCommandLine(cmd);
+    profiling.AddToCommandLine(cmd);
+    cmd.Parse(argc, argv);
+
+    //Cartesian product of all parameter lists
+    std::vector<uint32_t> nWifiValues = ParseUintList(nWifiList);
+    std::vector<uint32_t> packetSizes = ParseUintList(packetSizeList);
+    std::vector<std::string> dataRates = SplitList(dataRateList);
+    std::vector<SingleCellConfig> points;
+    for (uint32_t i = 0; i < nWifiValues.size(); i++) {
+        for (uint32_t j = 0; j < packetSizes.size(); j++) {
+            for (uint32_t k = 0; k < dataRates.size(); k++) {
+                SingleCellConfig config;
+                config.nWifi = nWifiValues[i];
+                config.packetSize = packetSizes[j];
+                config.dataRate = dataRates[k];
+                config.traffic = traffic;
+                config.phyMode = phyMode;
+                config.packetPool = packetPool;
+                config.simTime = simTime;
+                config.convergence = convergence;
+                config.measurement = measurement;
+                config.profiling = profiling;
+                config.cacheDir = cacheDir;
+                points.push_back(config);
+            }
+        }
+    }
+
+    if (replications == 0) {
+        replications = 1;
+    }
+    if (firstRun == 0) {
+        firstRun = RngSeedManager::GetRun();
+    }
+
+    if (engine != "sim" && engine != "model" && engine != "both") {
+        NS_FATAL_ERROR("Unknown engine " << engine);
+    }
+    ResultTableStream out(table, std::cout);
+    if (!out.IsOpen()) {
+        NS_FATAL_ERROR("Cannot open result table " << table);
+    }
+    SweepJob job(points, replications, firstRun, engine != "sim", output, out);
+
+    //Analytical screening: no simulation at all
+    if (engine == "model") {
+        for (uint32_t i = 0; i < points.size(); i++) {
+            job.WriteModel(i);
+        }
+        return 0;
+    }
+
+    //Serve cached runs first, simulate only the missing ones
+    std::vector<uint32_t> missing;
+    for (uint32_t i = 0; i < points.size() * replications; i++) {
+        std::string cached;
+        if (job.GetCached(i, cached)) {
+            job.Collect(i, true, cached);
+        } else {
+            missing.push_back(i);
+        }
+    }
+
+    WorkerPool pool(jobs);
+    std::cerr << "Sweep: " << points.size() << " points x " << replications << " replications, "
+            << points.size() * replications - missing.size() << " cached, " << missing.size() << " to simulate on " << pool.GetJobs() << " workers" << std::endl;
+    uint32_t failed = pool.Run(job, missing);
+
+    return failed == 0 ? 0 : 1;
+}
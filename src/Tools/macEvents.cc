@@ -0,0 +1,144 @@
+/* MAC event dump reader
+   ---------------------
+
+   Standalone reader of the MAC event rings dumped with --macEvents (see
+   Common/mac-event-recorder.h). It does not need ns-3:
+
+     g++ -O2 -o macEvents src/Tools/macEvents.cc
+
+     ./macEvents mac-events.bin                            every event, time ordered per dump
+     ./macEvents --node=3 --type=rtsTx,ctsTimeout mac-events.bin
+     ./macEvents --from=10.5 --to=10.6 mac-events.bin
+     ./macEvents --format=summary mac-events.bin           event counts per node and type
+
+   --section=i only prints the i-th dump of the file (0-based). Events of all
+   nodes are merged by time, like the lines of an NS_LOG run.
+*/
+
+#include "../Common/mac-event-ring.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+static bool IsEarlier(const MacEvent &a, const MacEvent &b) {
+    return a.time < b.time;
+}
+
+int main(int argc, char *argv[]) {
+
+    int64_t node = -1; //-1: all nodes
+    std::string typeList; //Empty: all event types
+    double from = 0.0; //seconds
+    double to = -1.0; //seconds, negative: no limit
+    int64_t sectionIndex = -1; //-1: all dumps
+    std::string format = "events";
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string::size_type eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--node") {
+            node = std::strtol(value.c_str(), 0, 10);
+        } else if (key == "--type") {
+            typeList = value;
+        } else if (key == "--from") {
+            from = std::strtod(value.c_str(), 0);
+        } else if (key == "--to") {
+            to = std::strtod(value.c_str(), 0);
+        } else if (key == "--section") {
+            sectionIndex = std::strtol(value.c_str(), 0, 10);
+        } else if (key == "--format") {
+            format = value;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Usage: macEvents [--node=N] [--type=a,b] [--from=s] [--to=s] [--section=i] [--format=events|summary] file..." << std::endl;
+            return arg == "--help" ? 0 : 1;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (format != "events" && format != "summary") {
+        std::cerr << "macEvents: unknown format " << format << std::endl;
+        return 1;
+    }
+    if (paths.empty()) {
+        std::cerr << "macEvents: no dump given" << std::endl;
+        return 1;
+    }
+
+    std::vector<bool> types(MacEvent::N_TYPES, typeList.empty());
+    std::istringstream list(typeList);
+    std::string name;
+    while (std::getline(list, name, ',')) {
+        uint32_t type = MacEvent::ParseType(name);
+        if (type == 0) {
+            std::cerr << "macEvents: unknown event type " << name << std::endl;
+            return 1;
+        }
+        types[type] = true;
+    }
+
+    for (uint32_t p = 0; p < paths.size(); p++) {
+        MacEventDump dump;
+        std::string error;
+        if (!dump.Read(paths[p], error)) {
+            std::cerr << "macEvents: " << error << std::endl;
+            return 1;
+        }
+        const std::vector<MacEventDump::Section> &sections = dump.GetSections();
+        for (uint32_t s = 0; s < sections.size(); s++) {
+            if (sectionIndex >= 0 && s != sectionIndex) {
+                continue;
+            }
+            const MacEventDump::Section &section = sections[s];
+            std::vector<MacEvent> events;
+            for (uint32_t n = 0; n < section.nodes.size(); n++) {
+                if (node >= 0 && section.nodes[n].nodeId != node) {
+                    continue;
+                }
+                const std::vector<MacEvent> &nodeEvents = section.nodes[n].events;
+                for (uint32_t e = 0; e < nodeEvents.size(); e++) {
+                    double time = nodeEvents[e].time / 1e9;
+                    if (nodeEvents[e].type < MacEvent::N_TYPES && types[nodeEvents[e].type]
+                            && time >= from && (to < 0 || time <= to)) {
+                        events.push_back(nodeEvents[e]);
+                    }
+                }
+            }
+            std::stable_sort(events.begin(), events.end(), IsEarlier);
+
+            std::cout << "# " << paths[p] << " dump " << s << " at +" << section.time / 1e9 << "s (" << section.reason << "), "
+                    << events.size() << " events" << std::endl;
+            if (format == "events") {
+                for (uint32_t e = 0; e < events.size(); e++) {
+                    std::cout << events[e].ToString() << "\n";
+                }
+                continue;
+            }
+            std::map<uint32_t, std::vector<uint64_t> > counts;
+            for (uint32_t e = 0; e < events.size(); e++) {
+                std::vector<uint64_t> &nodeCounts = counts[events[e].node];
+                nodeCounts.resize(MacEvent::N_TYPES, 0);
+                nodeCounts[events[e].type]++;
+            }
+            for (std::map<uint32_t, std::vector<uint64_t> >::const_iterator it = counts.begin(); it != counts.end(); ++it) {
+                std::cout << "node=" << it->first;
+                for (uint32_t type = 1; type < MacEvent::N_TYPES; type++) {
+                    if (it->second[type] > 0) {
+                        std::cout << " " << MacEvent::GetTypeName(type) << "=" << it->second[type];
+                    }
+                }
+                std::cout << std::endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,259 @@
+/* Result table reader
+   -------------------
+
+   Standalone reader of the binary result tables written with --table (see
+   Common/result-table.h). It does not need ns-3:
+
+     g++ -O2 -o resultTable src/Tools/resultTable.cc
+
+     ./resultTable runs.rtab                               blocks, tags and schemas
+     ./resultTable --tag=RESULT --format=csv runs.rtab     rows as CSV
+     ./resultTable --tag=WINDOW --columns=jain,start --format=stats *.rtab
+     ./resultTable --format=lines runs.rtab                the original RESULT/WINDOW lines
+     ./resultTable --import=variants.res --output=variants.rtab
+
+   Formats: schema (default), csv (one header per schema), lines, and stats
+   (count/mean/min/max of every numeric column, over all blocks of the tag).
+   --import converts text files of result lines (scenario --output, saved
+   stdout, the RUN lines of replications) into a table. The time to map and
+   index the files is reported on stderr.
+*/
+
+#include "../Common/result-table.h"
+
+#include <sys/time.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+struct Stats {
+    uint64_t count;
+    double sum;
+    double min;
+    double max;
+
+    Stats()
+    : count(0),
+      sum(0.0),
+      min(0.0),
+      max(0.0) {
+    }
+
+    void Add(double x) {
+        min = count == 0 ? x : std::min(min, x);
+        max = count == 0 ? x : std::max(max, x);
+        sum += x;
+        count++;
+    }
+};
+
+static double GetSeconds() {
+    struct timeval now;
+    gettimeofday(&now, 0);
+    return now.tv_sec + now.tv_usec * 1e-6;
+}
+
+static std::vector<std::string> Split(const std::string &list) {
+    std::vector<std::string> items;
+    std::istringstream is(list);
+    std::string item;
+    while (std::getline(is, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+//Columns of a block to print: the selection in its order, or all
+static std::vector<const ResultTable::Column *> Select(const ResultTable::Block &block, const std::vector<std::string> &columns) {
+    std::vector<const ResultTable::Column *> selected;
+    if (columns.empty()) {
+        for (uint32_t c = 0; c < block.columns.size(); c++) {
+            selected.push_back(&block.columns[c]);
+        }
+    }
+    for (uint32_t c = 0; c < columns.size(); c++) {
+        const ResultTable::Column *column = block.Find(columns[c]);
+        if (column != 0) {
+            selected.push_back(column);
+        }
+    }
+    return selected;
+}
+
+static int Import(const std::vector<std::string> &inputs, const std::string &output) {
+    if (output.empty()) {
+        std::cerr << "resultTable: --import needs --output" << std::endl;
+        return 1;
+    }
+    ResultTableWriter writer(output);
+    if (!writer.IsOpen()) {
+        return 1;
+    }
+    uint64_t rows = 0;
+    for (uint32_t i = 0; i < inputs.size(); i++) {
+        std::ifstream input(inputs[i].c_str());
+        if (!input) {
+            std::cerr << "resultTable: cannot open " << inputs[i] << std::endl;
+            return 1;
+        }
+        std::string line;
+        while (std::getline(input, line)) {
+            ResultRecord record;
+            if (ResultRecord::Parse(line, record) && !record.GetFields().empty()) {
+                writer.Add(record);
+                rows++;
+            }
+        }
+    }
+    writer.Close();
+    std::cerr << "resultTable: " << rows << " records appended to " << output << std::endl;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+
+    std::string tag; //Empty: all tags
+    std::string columnList; //Empty: all columns
+    std::string format = "schema";
+    std::string importList;
+    std::string output;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string::size_type eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "--tag") {
+            tag = value;
+        } else if (key == "--columns") {
+            columnList = value;
+        } else if (key == "--format") {
+            format = value;
+        } else if (key == "--import") {
+            importList = value;
+        } else if (key == "--output") {
+            output = value;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Usage: resultTable [--tag=T] [--columns=a,b] [--format=schema|csv|lines|stats] file..." << std::endl
+                    << "       resultTable --import=a.res,b.res --output=table.rtab" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+
+    if (!importList.empty()) {
+        return Import(Split(importList), output);
+    }
+    if (format != "schema" && format != "csv" && format != "lines" && format != "stats") {
+        std::cerr << "resultTable: unknown format " << format << std::endl;
+        return 1;
+    }
+    if (paths.empty()) {
+        std::cerr << "resultTable: no table given" << std::endl;
+        return 1;
+    }
+
+    //Map every file up front; the tables stay mapped until the end
+    double start = GetSeconds();
+    std::vector<ResultTable *> tables;
+    uint64_t rows = 0;
+    for (uint32_t i = 0; i < paths.size(); i++) {
+        tables.push_back(new ResultTable());
+        std::string error;
+        if (!tables.back()->Open(paths[i], error)) {
+            std::cerr << "resultTable: " << error << std::endl;
+            return 1;
+        }
+        rows += tables.back()->GetRows(tag);
+    }
+    std::cerr << "resultTable: " << rows << " rows in " << paths.size() << " files indexed in "
+            << (GetSeconds() - start) * 1000 << " ms" << std::endl;
+
+    std::vector<std::string> columns = Split(columnList);
+    std::string lastHeader;
+    std::map<std::string, Stats> stats;
+    std::vector<std::string> statsOrder;
+    for (uint32_t t = 0; t < tables.size(); t++) {
+        const std::vector<ResultTable::Block> &blocks = tables[t]->GetBlocks();
+        for (uint32_t b = 0; b < blocks.size(); b++) {
+            const ResultTable::Block &block = blocks[b];
+            if (!tag.empty() && block.tag != tag) {
+                continue;
+            }
+            std::vector<const ResultTable::Column *> selected = Select(block, columns);
+
+            if (format == "schema") {
+                std::cout << paths[t] << " block " << b << ": " << block.tag << ", " << block.rows << " rows" << std::endl;
+                for (uint32_t c = 0; c < selected.size(); c++) {
+                    std::cout << "  " << selected[c]->name << (selected[c]->type == ResultTable::F64 ? " f64" : " str") << std::endl;
+                }
+            } else if (format == "csv") {
+                std::string header = block.tag;
+                for (uint32_t c = 0; c < selected.size(); c++) {
+                    header += "," + selected[c]->name;
+                }
+                if (header != lastHeader) {
+                    std::cout << "tag";
+                    for (uint32_t c = 0; c < selected.size(); c++) {
+                        std::cout << "," << selected[c]->name;
+                    }
+                    std::cout << "\n";
+                    lastHeader = header;
+                }
+                for (uint32_t r = 0; r < block.rows; r++) {
+                    std::cout << block.tag;
+                    for (uint32_t c = 0; c < selected.size(); c++) {
+                        std::cout << "," << selected[c]->GetString(r);
+                    }
+                    std::cout << "\n";
+                }
+            } else if (format == "lines") {
+                for (uint32_t r = 0; r < block.rows; r++) {
+                    std::cout << block.tag;
+                    for (uint32_t c = 0; c < selected.size(); c++) {
+                        std::cout << " " << selected[c]->name << "=" << selected[c]->GetString(r);
+                    }
+                    std::cout << "\n";
+                }
+            } else {
+                //Numeric columns are read in place from the mapping
+                for (uint32_t c = 0; c < selected.size(); c++) {
+                    const double *values = selected[c]->GetDoubles();
+                    if (values == 0) {
+                        continue;
+                    }
+                    std::string key = block.tag + " " + selected[c]->name;
+                    if (stats.find(key) == stats.end()) {
+                        statsOrder.push_back(key);
+                    }
+                    Stats &column = stats[key];
+                    for (uint32_t r = 0; r < block.rows; r++) {
+                        column.Add(values[r]);
+                    }
+                }
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < statsOrder.size(); i++) {
+        const Stats &column = stats[statsOrder[i]];
+        std::cout << statsOrder[i] << " count=" << column.count << " mean=" << column.sum / column.count
+                << " min=" << column.min << " max=" << column.max << std::endl;
+    }
+
+    for (uint32_t t = 0; t < tables.size(); t++) {
+        delete tables[t];
+    }
+    return 0;
+}